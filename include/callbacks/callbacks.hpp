@@ -27,6 +27,12 @@
 
 #include "globals/globals.hpp"
 #include "utils/shader_utils.hpp"
+#include "utils/shader_watcher.hpp"
+#include "utils/render_scale.hpp"
+#include "utils/frame_pacer.hpp"
+#include "utils/input_latency.hpp"
+#include "utils/profiler.hpp"
+#include "game/input_record.hpp"
 
 #include "matrices.h"
 
@@ -44,6 +50,10 @@ void FramebufferSizeCallback(GLFWwindow *window, int width, int height)
     // "Screen Mapping" ou "Viewport Mapping" vista em aula ({+ViewportMapping2+}).
     glViewport(0, 0, width, height);
 
+    // A cena é renderizada em um framebuffer fora da tela com uma fração
+    // deste tamanho; veja render_scale.hpp.
+    ResizeDynamicResolution(width, height);
+
     // Atualizamos também a razão que define a proporção da janela (largura /
     // altura), a qual será utilizada na definição das matrizes de projeção,
     // tal que não ocorra distorções durante o processo de "Screen Mapping"
@@ -121,6 +131,10 @@ void CursorPosCallback(GLFWwindow *window, double xpos, double ypos)
     // instante de tempo, e usamos esta movimentação para atualizar os
     // parâmetros que definem a posição da câmera dentro da cena virtual.
     // Assim, temos que o usuário consegue controlar a câmera.
+    //
+    // Na reprodução de uma gravação os ângulos vêm do arquivo.
+    if (g_InputPlayer.active)
+        return;
 
     if (isFreeCamOn)
     {
@@ -176,6 +190,9 @@ void CursorPosCallback(GLFWwindow *window, double xpos, double ypos)
 // Função callback chamada sempre que o usuário movimenta a "rodinha" do mouse.
 void ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
 {
+    if (g_InputPlayer.active)
+        return;
+
     // Atualizamos a distância da câmera para a origem utilizando a
     // movimentação da "rodinha", simulando um ZOOM.
     g_CameraDistance -= 0.1f * yoffset;
@@ -202,6 +219,9 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
             std::exit(100 + i);
     // =====================
 
+    if (action == GLFW_PRESS)
+        NoteKeyPressed();
+
     // Se o usuário pressionar a tecla ESC, fechamos a janela.
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
@@ -211,6 +231,27 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
         should_restart = true;
     }
 
+    // Se o usuário apertar a tecla V, alternamos o modo de frame pacing
+    // (vsync, sem limite, limitado); veja frame_pacer.hpp.
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        CycleFramePacerMode();
+    }
+
+    // Se o usuário apertar a tecla L, a leitura da entrada passa a ser adiada
+    // até pouco antes do próximo "vblank"; veja input_latency.hpp.
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        ToggleWaitBeforeRender();
+    }
+
+    // Se o usuário apertar a tecla T, ligamos o profiler de CPU ou, se já
+    // estiver ligado, salvamos um trace dos últimos segundos; veja profiler.hpp.
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        ToggleProfilerCapture();
+    }
+
     if (game_over)
         return;
 
@@ -233,9 +274,10 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
     }
 
     // Se o usuário apertar a tecla R, recarregamos os shaders dos arquivos "shader_fragment.glsl" e "shader_vertex.glsl".
+    // A compilação ocorre em segundo plano; veja UpdateShaderHotReload().
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
-        ReloadShaders();
+        RequestShaderReload();
     }
 
     // "Teste" (ruim) de colisão com as paredes inserida abaixo:
@@ -294,12 +336,12 @@ void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mod)
     }
 
     // Não permite trocar pra freecam enquanto o pacman estiver indo para a posição inicial com a curva de Bezier,
-    // nem se a projeção atual for a ortográfica
-    if (key == GLFW_KEY_F && action == GLFW_PRESS && t >= 1 && g_UsePerspectiveProjection)
+    // nem se a projeção atual for a ortográfica. Tamanho e direção do pacman
+    // mudam no próximo passo de simulação (UpdatePacmanCameraMode()); na
+    // reprodução de uma gravação, a câmera livre vem do arquivo.
+    if (key == GLFW_KEY_F && action == GLFW_PRESS && t >= 1 && g_UsePerspectiveProjection && !g_InputPlayer.active)
     {
         isFreeCamOn = !isFreeCamOn;
-        pacman_rotation = isFreeCamOn ? pacman_initial_rotation : pacman_rotation;
-        pacman_size = (pacman_size == pacman_freecam_size) ? pacman_lookat_size : pacman_freecam_size;
     }
 }
 
@@ -0,0 +1,129 @@
+#pragma once
+
+// Micro-benchmarks dos kernels de simd_collisions.hpp ("--bench-collisions").
+// Cada versão suportada pela CPU testa a mesma esfera contra os mesmos
+// conjuntos aleatórios de esferas e AABBs; as máscaras resultantes são
+// comparadas com a versão escalar antes de o tempo ser mostrado.
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+#include "collisions/simd_collisions.hpp"
+
+struct CollisionBenchData
+{
+    std::vector<float> x, y, z, radius;
+    std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+    int count = 0;
+};
+
+static CollisionBenchData MakeCollisionBenchData(int count)
+{
+    // Mesma escala do labirinto (±10 em x/z), com semente fixa para que as
+    // execuções sejam comparáveis.
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> size(0.05f, 0.6f);
+
+    CollisionBenchData data;
+    data.count = count;
+    for (int i = 0; i < count; ++i)
+    {
+        float x = position(rng), z = position(rng), half = size(rng);
+        data.x.push_back(x);
+        data.y.push_back(-0.8f);
+        data.z.push_back(z);
+        data.radius.push_back(0.1f);
+        data.min_x.push_back(x - half);
+        data.min_y.push_back(-1.0f);
+        data.min_z.push_back(z - half);
+        data.max_x.push_back(x + half);
+        data.max_y.push_back(-0.5f);
+        data.max_z.push_back(z + half);
+    }
+    return data;
+}
+
+// Executa "kernel" com a esfera percorrendo a arena e retorna o tempo médio
+// por elemento testado, em nanossegundos.
+template <typename Kernel>
+static double TimeCollisionKernel(Kernel kernel, int count, int repetitions, std::vector<uint32_t> &mask)
+{
+    typedef std::chrono::steady_clock Clock;
+    volatile uint32_t sink = 0;
+
+    // Aquecimento: caches e, no caso do AVX2, a ativação das unidades de 256 bits
+    for (int r = 0; r < repetitions / 10 + 1; ++r)
+        kernel(Sphere{glm::vec3(0.0f, -0.8f, 0.0f), 0.35f}, mask.data());
+
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < repetitions; ++r)
+    {
+        float t = (float)r / repetitions;
+        Sphere s = {glm::vec3(-10.0f + 20.0f * t, -0.8f, 10.0f - 20.0f * t), 0.35f};
+        kernel(s, mask.data());
+        sink = sink + mask[0];
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    (void)sink;
+    return seconds * 1e9 / ((double)count * repetitions);
+}
+
+void RunCollisionBenchmarks()
+{
+    const int sizes[] = {64, 1024, 16384};
+    const CollisionKernelLevel levels[] = {COLLISION_KERNEL_SCALAR, COLLISION_KERNEL_SSE, COLLISION_KERNEL_AVX2};
+
+    printf("Collision kernels (best supported: %s)\n", CollisionKernelLevelName(CollisionKernelMaxLevel()));
+    printf("%-14s %7s %-7s %10s %8s\n", "test", "N", "kernel", "ns/elem", "speedup");
+
+    for (int n : sizes)
+    {
+        CollisionBenchData data = MakeCollisionBenchData(n);
+        SphereSoA spheres = {data.x.data(), data.y.data(), data.z.data(), data.radius.data(), n};
+        AABBSoA boxes = {data.min_x.data(), data.min_y.data(), data.min_z.data(),
+                         data.max_x.data(), data.max_y.data(), data.max_z.data(), n};
+        int repetitions = std::max(1, 20000000 / n);
+
+        for (int test = 0; test < 2; ++test)
+        {
+            std::vector<uint32_t> reference(HitMaskWords(n)), mask(HitMaskWords(n));
+            double scalar_ns = 0.0;
+
+            for (CollisionKernelLevel level : levels)
+            {
+                if (level > CollisionKernelMaxLevel())
+                    continue;
+                InitCollisionKernels(level);
+
+                double ns;
+                if (test == 0)
+                    ns = TimeCollisionKernel([&](Sphere s, uint32_t *out)
+                                             { SphereOverlapSpheres(s, spheres, out); }, n, repetitions, mask);
+                else
+                    ns = TimeCollisionKernel([&](Sphere s, uint32_t *out)
+                                             { SphereOverlapAABBs(s, boxes, out); }, n, repetitions, mask);
+
+                // A última esfera testada é a mesma para todas as versões
+                if (level == COLLISION_KERNEL_SCALAR)
+                {
+                    reference = mask;
+                    scalar_ns = ns;
+                }
+                else if (mask != reference)
+                {
+                    fprintf(stderr, "ERROR: %s kernel disagrees with scalar (N = %d)\n", CollisionKernelLevelName(level), n);
+                }
+
+                printf("%-14s %7d %-7s %10.3f %7.2fx\n", test == 0 ? "sphere-sphere" : "sphere-AABB", n,
+                       CollisionKernelLevelName(level), ns, scalar_ns / ns);
+            }
+        }
+    }
+
+    InitCollisionKernels();
+}
@@ -60,8 +60,8 @@ glm::vec3 AABBPointClosestToSphereCenter(AABB a, Sphere b)
 glm::vec4 checkSphereToAABBCollisionDirection(AABB a, Sphere b)
 {
     glm::vec3 closestPoint = AABBPointClosestToSphereCenter(a, b);
-    float dist = glm::distance(closestPoint, b.center);
-    if (dist <= b.radius)
+    glm::vec3 offset = closestPoint - b.center;
+    if (glm::dot(offset, offset) <= b.radius * b.radius)
     {
         glm::vec4 collision_direction = glm::vec4(closestPoint.x, closestPoint.y, closestPoint.z, 1.0f) -
                                         glm::vec4(b.center.x, b.center.y, b.center.z, 1.0f);
@@ -76,8 +76,10 @@ glm::vec4 checkSphereToAABBCollisionDirection(AABB a, Sphere b)
 // é porque houve colisão entre elas
 bool checkSphereToSphereCollision(Sphere a, Sphere b)
 {
-    float dist = glm::distance(a.center, b.center);
-    if (dist < a.radius + b.radius)
+    // Compara os quadrados para evitar a raiz quadrada de glm::distance()
+    glm::vec3 offset = a.center - b.center;
+    float radii = a.radius + b.radius;
+    if (glm::dot(offset, offset) < radii * radii)
     {
         return true;
     }
@@ -107,3 +109,114 @@ glm::vec4 cancelCollisionMovement(glm::vec4 movement, std::vector<glm::vec4> col
     }
     return movement;
 }
+
+// Teste contínuo: a esfera "s" se desloca "displacement" e pode colidir com
+// a caixa "a" no caminho. Retorna true se o primeiro contato acontece em
+// uma fração "toi" do deslocamento em [0, 1], junto com a normal da caixa
+// no ponto de contato (apontando para fora da caixa). Se a esfera já toca a
+// caixa no início, só há colisão quando o deslocamento a empurra para dentro
+// (toi = 0); afastar-se ou deslizar pela superfície é permitido.
+//
+// O Pac-Man só se desloca no plano do chão, então o teste é feito em x/z: a
+// distância vertical até a caixa não muda durante o deslocamento e apenas
+// reduz o raio do círculo que a esfera projeta no plano. A caixa expandida
+// por esse raio é um retângulo de cantos arredondados; o raio (centro +
+// t * deslocamento) é testado contra o retângulo expandido e, se entrar por
+// um dos cantos, contra o círculo daquele canto.
+bool sweepSphereToAABB(Sphere s, glm::vec3 displacement, AABB a, float &toi, glm::vec3 &normal)
+{
+    float dy = std::max(a.min.y, std::min(s.center.y, a.max.y)) - s.center.y;
+    if (std::abs(dy) >= s.radius)
+        return false;
+    float r = std::sqrt(s.radius * s.radius - dy * dy);
+
+    const float cx = s.center.x, cz = s.center.z;
+    const float dx = displacement.x, dz = displacement.z;
+
+    // Já em contato no início do deslocamento
+    float qx = std::max(a.min.x, std::min(cx, a.max.x));
+    float qz = std::max(a.min.z, std::min(cz, a.max.z));
+    float ox = cx - qx, oz = cz - qz;
+    if (ox * ox + oz * oz < r * r)
+    {
+        if (ox == 0.0f && oz == 0.0f)
+        {
+            // Centro dentro da caixa: sai pela face mais próxima
+            float to_min_x = cx - a.min.x, to_max_x = a.max.x - cx;
+            float to_min_z = cz - a.min.z, to_max_z = a.max.z - cz;
+            float nearest = std::min(std::min(to_min_x, to_max_x), std::min(to_min_z, to_max_z));
+            normal = nearest == to_min_x   ? glm::vec3(-1.0f, 0.0f, 0.0f)
+                     : nearest == to_max_x ? glm::vec3(1.0f, 0.0f, 0.0f)
+                     : nearest == to_min_z ? glm::vec3(0.0f, 0.0f, -1.0f)
+                                           : glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+        else
+        {
+            float length = std::sqrt(ox * ox + oz * oz);
+            normal = glm::vec3(ox / length, 0.0f, oz / length);
+        }
+        toi = 0.0f;
+        return normal.x * dx + normal.z * dz < 0.0f;
+    }
+    if (dx == 0.0f && dz == 0.0f)
+        return false;
+
+    // Raio contra o retângulo expandido (método das "slabs")
+    float t_enter = 0.0f, t_exit = 1.0f;
+    int enter_axis = -1;
+    const float origin[2] = {cx, cz};
+    const float direction[2] = {dx, dz};
+    const float box_min[2] = {a.min.x - r, a.min.z - r};
+    const float box_max[2] = {a.max.x + r, a.max.z + r};
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (direction[axis] == 0.0f)
+        {
+            if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis])
+                return false;
+            continue;
+        }
+        float t0 = (box_min[axis] - origin[axis]) / direction[axis];
+        float t1 = (box_max[axis] - origin[axis]) / direction[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        if (t0 > t_enter)
+        {
+            t_enter = t0;
+            enter_axis = axis;
+        }
+        t_exit = std::min(t_exit, t1);
+        if (t_enter > t_exit)
+            return false;
+    }
+    float px = cx + t_enter * dx, pz = cz + t_enter * dz;
+    bool outside_x = px < a.min.x || px > a.max.x;
+    bool outside_z = pz < a.min.z || pz > a.max.z;
+    if (!(outside_x && outside_z))
+    {
+        // Entrou por uma face
+        toi = t_enter;
+        normal = enter_axis == 0 ? glm::vec3(dx > 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f)
+                                 : glm::vec3(0.0f, 0.0f, dz > 0.0f ? -1.0f : 1.0f);
+        return true;
+    }
+
+    // Entrou pela região de um canto (ou já começa nela, com enter_axis = -1):
+    // raio contra o círculo do canto
+    float kx = px < a.min.x ? a.min.x : a.max.x;
+    float kz = pz < a.min.z ? a.min.z : a.max.z;
+    float mx = cx - kx, mz = cz - kz;
+    float qa = dx * dx + dz * dz;
+    float qb = mx * dx + mz * dz;
+    float qc = mx * mx + mz * mz - r * r;
+    float discriminant = qb * qb - qa * qc;
+    if (discriminant < 0.0f)
+        return false;
+    float t = (-qb - std::sqrt(discriminant)) / qa;
+    if (t < 0.0f || t > 1.0f)
+        return false;
+
+    toi = t;
+    normal = glm::vec3((mx + t * dx) / r, 0.0f, (mz + t * dz) / r);
+    return true;
+}
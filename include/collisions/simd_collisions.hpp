@@ -0,0 +1,249 @@
+#pragma once
+
+// Testes de colisão em lote: uma esfera contra N esferas, ou contra N AABBs,
+// guardadas em estrutura de arrays (SoA). O resultado é uma máscara com um
+// bit por elemento (bit i % 32 da palavra i / 32), no mesmo formato da
+// máscara de bolinhas vivas do PelletPool, para que possam ser combinadas
+// com um "E" bit a bit.
+//
+// Há três versões de cada teste: escalar, SSE (4 elementos por vez) e AVX2
+// (8 por vez). A versão é escolhida em tempo de execução de acordo com a CPU
+// (veja InitCollisionKernels()); fora de x86-64 somente a escalar existe.
+// Todas dão o mesmo resultado das funções de collisions.hpp:
+// esfera-esfera usa "<" e esfera-AABB usa "<=".
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "objects/objects.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PACMAN_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define PACMAN_TARGET_AVX2
+#else
+#define PACMAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+struct SphereSoA
+{
+    const float *x;
+    const float *y;
+    const float *z;
+    const float *radius;
+    int count;
+};
+
+struct AABBSoA
+{
+    const float *min_x, *min_y, *min_z;
+    const float *max_x, *max_y, *max_z;
+    int count;
+};
+
+// Número de palavras de 32 bits necessárias para a máscara de "count" itens.
+int HitMaskWords(int count)
+{
+    return (count + 31) / 32;
+}
+
+bool HitMaskTest(const uint32_t *mask, int i)
+{
+    return (mask[i / 32] >> (i % 32)) & 1u;
+}
+
+static void SphereOverlapSpheresScalar(Sphere s, const SphereSoA &spheres, int begin, uint32_t *mask)
+{
+    for (int i = begin; i < spheres.count; ++i)
+    {
+        float dx = spheres.x[i] - s.center.x;
+        float dy = spheres.y[i] - s.center.y;
+        float dz = spheres.z[i] - s.center.z;
+        float radii = spheres.radius[i] + s.radius;
+        if (dx * dx + dy * dy + dz * dz < radii * radii)
+            mask[i / 32] |= 1u << (i % 32);
+    }
+}
+
+static void SphereOverlapAABBsScalar(Sphere s, const AABBSoA &boxes, int begin, uint32_t *mask)
+{
+    for (int i = begin; i < boxes.count; ++i)
+    {
+        // Distância ao quadrado do centro da esfera ao ponto mais próximo do AABB
+        float dx = std::max(boxes.min_x[i], std::min(s.center.x, boxes.max_x[i])) - s.center.x;
+        float dy = std::max(boxes.min_y[i], std::min(s.center.y, boxes.max_y[i])) - s.center.y;
+        float dz = std::max(boxes.min_z[i], std::min(s.center.z, boxes.max_z[i])) - s.center.z;
+        if (dx * dx + dy * dy + dz * dz <= s.radius * s.radius)
+            mask[i / 32] |= 1u << (i % 32);
+    }
+}
+
+#ifdef PACMAN_SIMD_X86
+static void SphereOverlapSpheresSSE(Sphere s, const SphereSoA &spheres, uint32_t *mask)
+{
+    const __m128 cx = _mm_set1_ps(s.center.x);
+    const __m128 cy = _mm_set1_ps(s.center.y);
+    const __m128 cz = _mm_set1_ps(s.center.z);
+    const __m128 r = _mm_set1_ps(s.radius);
+
+    int i = 0;
+    for (; i + 4 <= spheres.count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(spheres.x + i), cx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(spheres.y + i), cy);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(spheres.z + i), cz);
+        __m128 radii = _mm_add_ps(_mm_loadu_ps(spheres.radius + i), r);
+        __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        uint32_t bits = (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(dist2, _mm_mul_ps(radii, radii)));
+        mask[i / 32] |= bits << (i % 32);
+    }
+    SphereOverlapSpheresScalar(s, spheres, i, mask);
+}
+
+static void SphereOverlapAABBsSSE(Sphere s, const AABBSoA &boxes, uint32_t *mask)
+{
+    const __m128 cx = _mm_set1_ps(s.center.x);
+    const __m128 cy = _mm_set1_ps(s.center.y);
+    const __m128 cz = _mm_set1_ps(s.center.z);
+    const __m128 r2 = _mm_set1_ps(s.radius * s.radius);
+
+    int i = 0;
+    for (; i + 4 <= boxes.count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_max_ps(_mm_loadu_ps(boxes.min_x + i), _mm_min_ps(cx, _mm_loadu_ps(boxes.max_x + i))), cx);
+        __m128 dy = _mm_sub_ps(_mm_max_ps(_mm_loadu_ps(boxes.min_y + i), _mm_min_ps(cy, _mm_loadu_ps(boxes.max_y + i))), cy);
+        __m128 dz = _mm_sub_ps(_mm_max_ps(_mm_loadu_ps(boxes.min_z + i), _mm_min_ps(cz, _mm_loadu_ps(boxes.max_z + i))), cz);
+        __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        uint32_t bits = (uint32_t)_mm_movemask_ps(_mm_cmple_ps(dist2, r2));
+        mask[i / 32] |= bits << (i % 32);
+    }
+    SphereOverlapAABBsScalar(s, boxes, i, mask);
+}
+
+PACMAN_TARGET_AVX2 static void SphereOverlapSpheresAVX2(Sphere s, const SphereSoA &spheres, uint32_t *mask)
+{
+    const __m256 cx = _mm256_set1_ps(s.center.x);
+    const __m256 cy = _mm256_set1_ps(s.center.y);
+    const __m256 cz = _mm256_set1_ps(s.center.z);
+    const __m256 r = _mm256_set1_ps(s.radius);
+
+    int i = 0;
+    for (; i + 8 <= spheres.count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(spheres.x + i), cx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(spheres.y + i), cy);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(spheres.z + i), cz);
+        __m256 radii = _mm256_add_ps(_mm256_loadu_ps(spheres.radius + i), r);
+        __m256 dist2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(dist2, _mm256_mul_ps(radii, radii), _CMP_LT_OQ));
+        mask[i / 32] |= bits << (i % 32);
+    }
+    // O compilador não insere vzeroupper antes da chamada em cauda; sem ele o
+    // código SSE da versão escalar paga a transição AVX-SSE a cada instrução.
+    _mm256_zeroupper();
+    SphereOverlapSpheresScalar(s, spheres, i, mask);
+}
+
+PACMAN_TARGET_AVX2 static void SphereOverlapAABBsAVX2(Sphere s, const AABBSoA &boxes, uint32_t *mask)
+{
+    const __m256 cx = _mm256_set1_ps(s.center.x);
+    const __m256 cy = _mm256_set1_ps(s.center.y);
+    const __m256 cz = _mm256_set1_ps(s.center.z);
+    const __m256 r2 = _mm256_set1_ps(s.radius * s.radius);
+
+    int i = 0;
+    for (; i + 8 <= boxes.count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_max_ps(_mm256_loadu_ps(boxes.min_x + i), _mm256_min_ps(cx, _mm256_loadu_ps(boxes.max_x + i))), cx);
+        __m256 dy = _mm256_sub_ps(_mm256_max_ps(_mm256_loadu_ps(boxes.min_y + i), _mm256_min_ps(cy, _mm256_loadu_ps(boxes.max_y + i))), cy);
+        __m256 dz = _mm256_sub_ps(_mm256_max_ps(_mm256_loadu_ps(boxes.min_z + i), _mm256_min_ps(cz, _mm256_loadu_ps(boxes.max_z + i))), cz);
+        __m256 dist2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(dist2, r2, _CMP_LE_OQ));
+        mask[i / 32] |= bits << (i % 32);
+    }
+    _mm256_zeroupper();
+    SphereOverlapAABBsScalar(s, boxes, i, mask);
+}
+
+static bool CpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+enum CollisionKernelLevel
+{
+    COLLISION_KERNEL_SCALAR,
+    COLLISION_KERNEL_SSE,
+    COLLISION_KERNEL_AVX2
+};
+
+const char *CollisionKernelLevelName(CollisionKernelLevel level)
+{
+    static const char *names[] = {"scalar", "SSE", "AVX2"};
+    return names[level];
+}
+
+// Melhor versão suportada por esta CPU
+CollisionKernelLevel CollisionKernelMaxLevel()
+{
+#ifdef PACMAN_SIMD_X86
+    static const bool has_avx2 = CpuSupportsAVX2();
+    return has_avx2 ? COLLISION_KERNEL_AVX2 : COLLISION_KERNEL_SSE; // SSE2 faz parte do x86-64
+#else
+    return COLLISION_KERNEL_SCALAR;
+#endif
+}
+
+CollisionKernelLevel g_CollisionKernelLevel = COLLISION_KERNEL_SCALAR;
+
+// Escolhe a versão usada pelo jogo. Pode ser chamada de novo para forçar uma
+// versão inferior (os micro-benchmarks comparam as três).
+void InitCollisionKernels(CollisionKernelLevel requested = COLLISION_KERNEL_AVX2)
+{
+    g_CollisionKernelLevel = std::min(requested, CollisionKernelMaxLevel());
+}
+
+// Preenche "mask" (HitMaskWords(spheres.count) palavras) com um bit para cada
+// esfera que sobrepõe "s".
+void SphereOverlapSpheres(Sphere s, const SphereSoA &spheres, uint32_t *mask)
+{
+    memset(mask, 0, HitMaskWords(spheres.count) * sizeof(uint32_t));
+#ifdef PACMAN_SIMD_X86
+    if (g_CollisionKernelLevel == COLLISION_KERNEL_AVX2)
+        return SphereOverlapSpheresAVX2(s, spheres, mask);
+    if (g_CollisionKernelLevel == COLLISION_KERNEL_SSE)
+        return SphereOverlapSpheresSSE(s, spheres, mask);
+#endif
+    SphereOverlapSpheresScalar(s, spheres, 0, mask);
+}
+
+// Preenche "mask" (HitMaskWords(boxes.count) palavras) com um bit para cada
+// AABB cujo ponto mais próximo do centro de "s" está a até s.radius dele.
+void SphereOverlapAABBs(Sphere s, const AABBSoA &boxes, uint32_t *mask)
+{
+    memset(mask, 0, HitMaskWords(boxes.count) * sizeof(uint32_t));
+#ifdef PACMAN_SIMD_X86
+    if (g_CollisionKernelLevel == COLLISION_KERNEL_AVX2)
+        return SphereOverlapAABBsAVX2(s, boxes, mask);
+    if (g_CollisionKernelLevel == COLLISION_KERNEL_SSE)
+        return SphereOverlapAABBsSSE(s, boxes, mask);
+#endif
+    SphereOverlapAABBsScalar(s, boxes, 0, mask);
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+// Grade uniforme sobre o plano x/z da arena. Cada objeto é guardado na célula
+// que contém o seu centro; uma consulta percorre somente as células que o
+// volume consultado toca. Com o tamanho da célula fixo, o número de células
+// visitadas não depende de quantos objetos existem na arena.
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <external/glm/vec3.hpp>
+#include <external/glm/common.hpp>
+#include <external/glm/geometric.hpp>
+
+#include "objects/objects.hpp"
+#include "objects/pellet_pool.hpp"
+#include "collisions/simd_collisions.hpp"
+
+struct UniformGrid2D
+{
+    float origin_x = 0.0f;
+    float origin_z = 0.0f;
+    float cell_size = 1.0f;
+    int columns = 0; // Células ao longo de x
+    int rows = 0;    // Células ao longo de z
+};
+
+// Cria uma grade que cobre o retângulo [min, max] (somente x e z são usados).
+UniformGrid2D MakeUniformGrid2D(glm::vec3 min, glm::vec3 max, float cell_size)
+{
+    UniformGrid2D grid;
+    grid.origin_x = min.x;
+    grid.origin_z = min.z;
+    grid.cell_size = cell_size;
+    grid.columns = std::max(1, (int)std::floor((max.x - min.x) / cell_size) + 1);
+    grid.rows = std::max(1, (int)std::floor((max.z - min.z) / cell_size) + 1);
+    return grid;
+}
+
+int GridColumn(const UniformGrid2D &grid, float x)
+{
+    int column = (int)std::floor((x - grid.origin_x) / grid.cell_size);
+    return std::min(std::max(column, 0), grid.columns - 1);
+}
+
+int GridRow(const UniformGrid2D &grid, float z)
+{
+    int row = (int)std::floor((z - grid.origin_z) / grid.cell_size);
+    return std::min(std::max(row, 0), grid.rows - 1);
+}
+
+int GridCellIndex(const UniformGrid2D &grid, int column, int row)
+{
+    return row * grid.columns + column;
+}
+
+// Handles das bolinhas agrupados por célula, em um único vetor contíguo: os
+// da célula c ficam em handles[cell_start[c] .. cell_start[c + 1]). Centro e
+// raio são copiados na mesma ordem, para que as células vizinhas de uma
+// mesma linha formem um trecho contíguo testado de uma vez pelos kernels de
+// simd_collisions.hpp. A grade não muda durante o jogo; bolinhas comidas são
+// puladas pela máscara de bits do PelletPool.
+struct PelletGrid
+{
+    UniformGrid2D grid;
+    std::vector<int> cell_start;
+    std::vector<int> handles;
+    std::vector<float> center_x, center_y, center_z, radius;
+    float max_radius = 0.0f;
+
+    // Máscara de FindPelletsTouching(), reaproveitada entre consultas
+    std::vector<uint32_t> query_mask;
+};
+
+// Lado de cada célula. As bolinhas ficam a 0.5 de distância umas das outras
+// e a esfera de colisão do Pac-Man tem raio bem menor que isso, então uma
+// consulta toca no máximo 2x2 células.
+const float PELLET_GRID_CELL_SIZE = 1.0f;
+
+void BuildPelletGrid(PelletGrid &pellet_grid, const PelletPool &pool)
+{
+    int count = PelletCapacity(pool);
+    pellet_grid.max_radius = 0.0f;
+
+    glm::vec3 min(0.0f), max(0.0f);
+    for (int h = 0; h < count; ++h)
+    {
+        glm::vec3 center = PelletCenter(pool, h);
+        min = h == 0 ? center : glm::min(min, center);
+        max = h == 0 ? center : glm::max(max, center);
+        pellet_grid.max_radius = std::max(pellet_grid.max_radius, pool.radius[h]);
+    }
+    pellet_grid.grid = MakeUniformGrid2D(min, max, PELLET_GRID_CELL_SIZE);
+
+    const UniformGrid2D &grid = pellet_grid.grid;
+    int cell_total = grid.columns * grid.rows;
+    pellet_grid.cell_start.assign(cell_total + 1, 0);
+
+    // Ordenação por contagem: conta, acumula e distribui.
+    std::vector<int> cells(count);
+    for (int h = 0; h < count; ++h)
+    {
+        cells[h] = GridCellIndex(grid, GridColumn(grid, pool.center_x[h]), GridRow(grid, pool.center_z[h]));
+        pellet_grid.cell_start[cells[h] + 1] += 1;
+    }
+    for (int c = 0; c < cell_total; ++c)
+        pellet_grid.cell_start[c + 1] += pellet_grid.cell_start[c];
+
+    pellet_grid.handles.resize(count);
+    pellet_grid.center_x.resize(count);
+    pellet_grid.center_y.resize(count);
+    pellet_grid.center_z.resize(count);
+    pellet_grid.radius.resize(count);
+    std::vector<int> cursor(pellet_grid.cell_start.begin(), pellet_grid.cell_start.end() - 1);
+    for (int h = 0; h < count; ++h)
+    {
+        int i = cursor[cells[h]]++;
+        pellet_grid.handles[i] = h;
+        pellet_grid.center_x[i] = pool.center_x[h];
+        pellet_grid.center_y[i] = pool.center_y[h];
+        pellet_grid.center_z[i] = pool.center_z[h];
+        pellet_grid.radius[i] = pool.radius[h];
+    }
+
+    // Nenhuma linha consultada tem mais bolinhas que a grade inteira
+    pellet_grid.query_mask.resize(HitMaskWords(count));
+}
+
+// Acrescenta em "hits" os handles das bolinhas vivas que tocam "sphere".
+// As células de uma linha da grade são testadas juntas por
+// SphereOverlapSpheres(), que compara distâncias ao quadrado. Não aloca
+// memória; a grade não pode ser consultada por duas threads ao mesmo tempo.
+void FindPelletsTouching(PelletGrid &pellet_grid, const PelletPool &pool, Sphere sphere, std::vector<int> &hits)
+{
+    if (pellet_grid.handles.empty())
+        return;
+
+    const UniformGrid2D &grid = pellet_grid.grid;
+    float reach = sphere.radius + pellet_grid.max_radius;
+    int column_min = GridColumn(grid, sphere.center.x - reach);
+    int column_max = GridColumn(grid, sphere.center.x + reach);
+    int row_min = GridRow(grid, sphere.center.z - reach);
+    int row_max = GridRow(grid, sphere.center.z + reach);
+
+    uint32_t *mask = pellet_grid.query_mask.data();
+    for (int row = row_min; row <= row_max; ++row)
+    {
+        int begin = pellet_grid.cell_start[GridCellIndex(grid, column_min, row)];
+        int end = pellet_grid.cell_start[GridCellIndex(grid, column_max, row) + 1];
+        if (begin == end)
+            continue;
+
+        SphereSoA span = {pellet_grid.center_x.data() + begin, pellet_grid.center_y.data() + begin,
+                          pellet_grid.center_z.data() + begin, pellet_grid.radius.data() + begin, end - begin};
+        SphereOverlapSpheres(sphere, span, mask);
+
+        for (int i = 0; i < span.count; ++i)
+        {
+            int h = pellet_grid.handles[begin + i];
+            if (HitMaskTest(mask, i) && IsPelletAlive(pool, h))
+                hits.push_back(h);
+        }
+    }
+}
+
+// Paredes (AABBs estáticos) na mesma grade. Uma parede entra em todas as
+// células que a sua caixa cobre no plano x/z. Como na grade de bolinhas, os
+// cantos são copiados na ordem das células, para que cada linha consultada
+// seja um único trecho contíguo para SphereOverlapAABBs().
+struct WallGrid
+{
+    UniformGrid2D grid;
+    std::vector<int> cell_start;
+    std::vector<int> wall_index; // Índice da parede no vetor original
+    std::vector<float> min_x, min_y, min_z;
+    std::vector<float> max_x, max_y, max_z;
+    std::vector<AABB> boxes; // Na ordem original
+
+    // Rascunho das consultas, reaproveitado: máscara de FindWallsTouching()
+    // e paredes próximas em moveSphereThroughWalls() (wall.hpp)
+    std::vector<uint32_t> query_mask;
+    std::vector<int> nearby;
+};
+
+// Com células de 1.0, cada parede do labirinto ocupa poucas células e a
+// esfera do Pac-Man (diâmetro menor que 1.0) toca no máximo 2x2.
+const float WALL_GRID_CELL_SIZE = 1.0f;
+
+void BuildWallGrid(WallGrid &wall_grid, const std::vector<AABB> &boxes)
+{
+    glm::vec3 min(0.0f), max(0.0f);
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        min = i == 0 ? boxes[i].min : glm::min(min, boxes[i].min);
+        max = i == 0 ? boxes[i].max : glm::max(max, boxes[i].max);
+    }
+    wall_grid.grid = MakeUniformGrid2D(min, max, WALL_GRID_CELL_SIZE);
+    wall_grid.boxes = boxes;
+
+    const UniformGrid2D &grid = wall_grid.grid;
+    int cell_total = grid.columns * grid.rows;
+    wall_grid.cell_start.assign(cell_total + 1, 0);
+
+    // Ordenação por contagem, como em BuildPelletGrid(), mas cada parede
+    // conta uma vez para cada célula que cobre.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::vector<int> cursor;
+        if (pass == 1)
+        {
+            for (int c = 0; c < cell_total; ++c)
+                wall_grid.cell_start[c + 1] += wall_grid.cell_start[c];
+
+            int total = wall_grid.cell_start[cell_total];
+            wall_grid.wall_index.resize(total);
+            wall_grid.min_x.resize(total);
+            wall_grid.min_y.resize(total);
+            wall_grid.min_z.resize(total);
+            wall_grid.max_x.resize(total);
+            wall_grid.max_y.resize(total);
+            wall_grid.max_z.resize(total);
+            cursor.assign(wall_grid.cell_start.begin(), wall_grid.cell_start.end() - 1);
+        }
+
+        for (size_t w = 0; w < boxes.size(); ++w)
+        {
+            const AABB &box = boxes[w];
+            for (int row = GridRow(grid, box.min.z); row <= GridRow(grid, box.max.z); ++row)
+            {
+                for (int column = GridColumn(grid, box.min.x); column <= GridColumn(grid, box.max.x); ++column)
+                {
+                    int cell = GridCellIndex(grid, column, row);
+                    if (pass == 0)
+                    {
+                        wall_grid.cell_start[cell + 1] += 1;
+                        continue;
+                    }
+
+                    int i = cursor[cell]++;
+                    wall_grid.wall_index[i] = (int)w;
+                    wall_grid.min_x[i] = box.min.x;
+                    wall_grid.min_y[i] = box.min.y;
+                    wall_grid.min_z[i] = box.min.z;
+                    wall_grid.max_x[i] = box.max.x;
+                    wall_grid.max_y[i] = box.max.y;
+                    wall_grid.max_z[i] = box.max.z;
+                }
+            }
+        }
+    }
+
+    // Nenhuma linha consultada tem mais entradas que a grade inteira
+    wall_grid.query_mask.resize(HitMaskWords((int)wall_grid.wall_index.size()));
+    wall_grid.nearby.reserve(64);
+}
+
+// Acrescenta em "hits" o índice de cada parede cuja caixa toca "sphere",
+// sem repetições, em ordem crescente. Não aloca memória enquanto "hits"
+// tiver capacidade; a grade não pode ser consultada por duas threads ao
+// mesmo tempo.
+void FindWallsTouching(WallGrid &wall_grid, Sphere sphere, std::vector<int> &hits)
+{
+    if (wall_grid.wall_index.empty())
+        return;
+
+    const UniformGrid2D &grid = wall_grid.grid;
+    int column_min = GridColumn(grid, sphere.center.x - sphere.radius);
+    int column_max = GridColumn(grid, sphere.center.x + sphere.radius);
+    int row_min = GridRow(grid, sphere.center.z - sphere.radius);
+    int row_max = GridRow(grid, sphere.center.z + sphere.radius);
+
+    size_t first_hit = hits.size();
+    uint32_t *mask = wall_grid.query_mask.data();
+    for (int row = row_min; row <= row_max; ++row)
+    {
+        int begin = wall_grid.cell_start[GridCellIndex(grid, column_min, row)];
+        int end = wall_grid.cell_start[GridCellIndex(grid, column_max, row) + 1];
+        if (begin == end)
+            continue;
+
+        AABBSoA span = {wall_grid.min_x.data() + begin, wall_grid.min_y.data() + begin, wall_grid.min_z.data() + begin,
+                        wall_grid.max_x.data() + begin, wall_grid.max_y.data() + begin, wall_grid.max_z.data() + begin,
+                        end - begin};
+        SphereOverlapAABBs(sphere, span, mask);
+
+        for (int i = 0; i < span.count; ++i)
+        {
+            if (HitMaskTest(mask, i))
+                hits.push_back(wall_grid.wall_index[begin + i]);
+        }
+    }
+
+    // Uma parede que cobre várias das células consultadas aparece uma vez
+    // por célula.
+    std::sort(hits.begin() + first_hit, hits.end());
+    hits.erase(std::unique(hits.begin() + first_hit, hits.end()), hits.end());
+}
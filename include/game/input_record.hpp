@@ -0,0 +1,394 @@
+#pragma once
+
+// Gravação e reprodução da entrada do jogo, passo a passo.
+//
+// A simulação (simulation.hpp) só depende da entrada de cada passo, então
+// gravar essa entrada basta para repetir um jogo inteiro: "--record arquivo"
+// grava, "--replay arquivo" reproduz com o mesmo número de passos, sem ler o
+// teclado nem o relógio. Ao final da reprodução o resumo do estado
+// (SimulationChecksum()) é comparado com o gravado.
+//
+// Formato do arquivo (inteiros em little-endian):
+//
+//     "PMRC"  u8 versão  u8 reservado  u16 passos por segundo  u32 semente
+//     registros...
+//
+// Cada registro é "varint passos desde o registro anterior", "u8 flags" e,
+// se INPUT_FLAG_CAMERA estiver ligada, 9 floats: forward_unit.xyz,
+// side_unit.xyz, theta, phi e distância da câmera. Um registro só é escrito
+// quando a entrada muda e vale até o próximo. O último registro tem somente
+// INPUT_FLAG_END, seguido de "varint total de passos" e "u64 checksum".
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <external/glm/vec4.hpp>
+
+#include "globals/globals.hpp"
+#include "objects/pacman.hpp"
+#include "game/simulation.hpp"
+
+const uint8_t INPUT_RECORD_VERSION = 1;
+
+// Passos executados por quadro ao reproduzir uma gravação com janela: o
+// equivalente a 60 quadros por segundo de jogo.
+const int REPLAY_TICKS_PER_FRAME = (int)(SIMULATION_HZ / 60.0);
+
+enum InputRecordFlags
+{
+    INPUT_FLAG_FORWARD = 1 << 0,
+    INPUT_FLAG_BACKWARD = 1 << 1,
+    INPUT_FLAG_RIGHT = 1 << 2,
+    INPUT_FLAG_LEFT = 1 << 3,
+    INPUT_FLAG_FREE_CAM = 1 << 4,
+    INPUT_FLAG_RESTART = 1 << 5, // O jogo é reiniciado antes deste passo
+    INPUT_FLAG_CAMERA = 1 << 6,  // Direções e ângulos da câmera mudaram
+    INPUT_FLAG_END = 1 << 7,
+};
+
+// Tudo o que um passo de simulação lê da entrada. A câmera livre também muda
+// o raio de colisão dos fantasmas, por isso é gravada junto com as teclas.
+struct RecordedInput
+{
+    PacmanInput pacman;
+    bool free_cam;
+    bool restart;
+    float camera_theta;
+    float camera_phi;
+    float camera_distance;
+};
+
+// Entrada atual: teclas e direções de "pacman" e o estado da câmera nos globais.
+RecordedInput CaptureInput(const PacmanInput &pacman, bool restart)
+{
+    RecordedInput input;
+    input.pacman = pacman;
+    input.free_cam = isFreeCamOn;
+    input.restart = restart;
+    input.camera_theta = g_CameraTheta;
+    input.camera_phi = g_CameraPhi;
+    input.camera_distance = g_CameraDistance;
+    return input;
+}
+
+// Executa um passo com a entrada gravada, reiniciando o jogo antes se ela pedir.
+void RunRecordedTick(const RecordedInput &input)
+{
+    if (input.restart)
+        InitializeWorld();
+
+    isFreeCamOn = input.free_cam;
+    g_CameraTheta = input.camera_theta;
+    g_CameraPhi = input.camera_phi;
+    g_CameraDistance = input.camera_distance;
+    SimulationTick(input.pacman);
+}
+
+uint8_t InputKeyFlags(const RecordedInput &input)
+{
+    return (input.pacman.forward ? INPUT_FLAG_FORWARD : 0) | (input.pacman.backward ? INPUT_FLAG_BACKWARD : 0) |
+           (input.pacman.right ? INPUT_FLAG_RIGHT : 0) | (input.pacman.left ? INPUT_FLAG_LEFT : 0) |
+           (input.free_cam ? INPUT_FLAG_FREE_CAM : 0);
+}
+
+bool SameInputCamera(const RecordedInput &a, const RecordedInput &b)
+{
+    return a.pacman.forward_unit == b.pacman.forward_unit && a.pacman.side_unit == b.pacman.side_unit &&
+           a.camera_theta == b.camera_theta && a.camera_phi == b.camera_phi && a.camera_distance == b.camera_distance;
+}
+
+void WriteRecordUint(std::vector<uint8_t> &bytes, uint64_t value, int size)
+{
+    for (int i = 0; i < size; ++i)
+        bytes.push_back((uint8_t)(value >> (8 * i)));
+}
+
+void WriteRecordVarint(std::vector<uint8_t> &bytes, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+void WriteRecordFloat(std::vector<uint8_t> &bytes, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteRecordUint(bytes, bits, 4);
+}
+
+struct InputRecorder
+{
+    bool active = false;
+    std::string filename;
+    std::vector<uint8_t> bytes; // O arquivo inteiro, escrito ao final
+    RecordedInput last;         // Entrada do último registro
+    long long tick = 0;         // Passos gravados
+    long long last_record_tick = 0;
+    bool restart_pending = false;
+};
+
+InputRecorder g_InputRecorder;
+
+void StartInputRecording(InputRecorder &recorder, const char *filename, uint32_t seed)
+{
+    recorder = InputRecorder();
+    recorder.active = true;
+    recorder.filename = filename;
+
+    const char magic[4] = {'P', 'M', 'R', 'C'};
+    recorder.bytes.insert(recorder.bytes.end(), magic, magic + 4);
+    recorder.bytes.push_back(INPUT_RECORD_VERSION);
+    recorder.bytes.push_back(0);
+    WriteRecordUint(recorder.bytes, (uint64_t)SIMULATION_HZ, 2);
+    WriteRecordUint(recorder.bytes, seed, 4);
+}
+
+// O reinício é aplicado no próximo passo gravado, antes da simulação dele.
+void NoteInputRestart(InputRecorder &recorder)
+{
+    recorder.restart_pending = true;
+}
+
+// Grava a entrada de um passo; chamada uma vez para cada SimulationTick().
+void RecordInputTick(InputRecorder &recorder, RecordedInput input)
+{
+    if (!recorder.active)
+        return;
+
+    input.restart = input.restart || recorder.restart_pending;
+    recorder.restart_pending = false;
+
+    bool first = recorder.tick == 0;
+    bool camera_changed = first || !SameInputCamera(input, recorder.last);
+    if (first || camera_changed || input.restart || InputKeyFlags(input) != InputKeyFlags(recorder.last))
+    {
+        uint8_t flags = InputKeyFlags(input) | (input.restart ? INPUT_FLAG_RESTART : 0) | (camera_changed ? INPUT_FLAG_CAMERA : 0);
+        WriteRecordVarint(recorder.bytes, (uint64_t)(recorder.tick - recorder.last_record_tick));
+        recorder.bytes.push_back(flags);
+        if (camera_changed)
+        {
+            const float camera[9] = {input.pacman.forward_unit.x, input.pacman.forward_unit.y, input.pacman.forward_unit.z,
+                                     input.pacman.side_unit.x, input.pacman.side_unit.y, input.pacman.side_unit.z,
+                                     input.camera_theta, input.camera_phi, input.camera_distance};
+            for (float value : camera)
+                WriteRecordFloat(recorder.bytes, value);
+        }
+        recorder.last = input;
+        recorder.last_record_tick = recorder.tick;
+    }
+    recorder.tick += 1;
+}
+
+// Fecha a gravação com o resumo do estado final e escreve o arquivo.
+bool FinishInputRecording(InputRecorder &recorder, uint64_t checksum)
+{
+    if (!recorder.active)
+        return false;
+    recorder.active = false;
+
+    WriteRecordVarint(recorder.bytes, (uint64_t)(recorder.tick - recorder.last_record_tick));
+    recorder.bytes.push_back(INPUT_FLAG_END);
+    WriteRecordVarint(recorder.bytes, (uint64_t)recorder.tick);
+    WriteRecordUint(recorder.bytes, checksum, 8);
+
+    FILE *file = fopen(recorder.filename.c_str(), "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", recorder.filename.c_str());
+        return false;
+    }
+    fwrite(recorder.bytes.data(), 1, recorder.bytes.size(), file);
+    fclose(file);
+
+    fprintf(stdout, "Entrada gravada em \"%s\" (%lld passos, %zu bytes, checksum %016llx).\n",
+            recorder.filename.c_str(), recorder.tick, recorder.bytes.size(), (unsigned long long)checksum);
+    fflush(stdout);
+    return true;
+}
+
+struct InputPlayer
+{
+    bool active = false;
+    std::string filename;
+    std::vector<uint8_t> bytes;
+    size_t cursor = 0;
+    uint32_t seed = 0;
+
+    RecordedInput current;       // Entrada em vigor
+    RecordedInput next;          // Próximo registro já decodificado
+    long long tick = 0;          // Passos já reproduzidos
+    long long next_tick = 0;     // Passo em que "next" entra em vigor (-1: fim)
+    long long total_ticks = -1;  // Conhecido ao decodificar o registro final
+    uint64_t checksum = 0;
+};
+
+InputPlayer g_InputPlayer;
+
+bool ReadRecordUint(InputPlayer &player, int size, uint64_t &value)
+{
+    if (player.cursor + size > player.bytes.size())
+        return false;
+    value = 0;
+    for (int i = 0; i < size; ++i)
+        value |= (uint64_t)player.bytes[player.cursor++] << (8 * i);
+    return true;
+}
+
+bool ReadRecordVarint(InputPlayer &player, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (player.cursor >= player.bytes.size())
+            return false;
+        uint8_t byte = player.bytes[player.cursor++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool ReadRecordFloat(InputPlayer &player, float &value)
+{
+    uint64_t bits;
+    if (!ReadRecordUint(player, 4, bits))
+        return false;
+    uint32_t bits32 = (uint32_t)bits;
+    memcpy(&value, &bits32, sizeof(value));
+    return true;
+}
+
+// Decodifica o registro seguinte para "player.next".
+bool ReadNextInputRecord(InputPlayer &player)
+{
+    uint64_t delta, flags;
+    if (!ReadRecordVarint(player, delta) || !ReadRecordUint(player, 1, flags))
+        return false;
+
+    long long record_tick = (player.next_tick < 0 ? 0 : player.next_tick) + (long long)delta;
+    if (flags & INPUT_FLAG_END)
+    {
+        uint64_t total, checksum;
+        if (!ReadRecordVarint(player, total) || !ReadRecordUint(player, 8, checksum) || (long long)total != record_tick)
+            return false;
+        player.total_ticks = (long long)total;
+        player.checksum = checksum;
+        player.next_tick = -1;
+        return true;
+    }
+
+    RecordedInput &input = player.next;
+    input.pacman.forward = (flags & INPUT_FLAG_FORWARD) != 0;
+    input.pacman.backward = (flags & INPUT_FLAG_BACKWARD) != 0;
+    input.pacman.right = (flags & INPUT_FLAG_RIGHT) != 0;
+    input.pacman.left = (flags & INPUT_FLAG_LEFT) != 0;
+    input.free_cam = (flags & INPUT_FLAG_FREE_CAM) != 0;
+    input.restart = (flags & INPUT_FLAG_RESTART) != 0;
+    if (flags & INPUT_FLAG_CAMERA)
+    {
+        float camera[9];
+        for (float &value : camera)
+        {
+            if (!ReadRecordFloat(player, value))
+                return false;
+        }
+        input.pacman.forward_unit = glm::vec4(camera[0], camera[1], camera[2], 0.0f);
+        input.pacman.side_unit = glm::vec4(camera[3], camera[4], camera[5], 0.0f);
+        input.camera_theta = camera[6];
+        input.camera_phi = camera[7];
+        input.camera_distance = camera[8];
+    }
+    else if (player.next_tick < 0)
+    {
+        return false; // O primeiro registro sempre traz a câmera
+    }
+    player.next_tick = record_tick;
+    return true;
+}
+
+bool OpenInputReplay(InputPlayer &player, const char *filename)
+{
+    player = InputPlayer();
+    player.filename = filename;
+    player.next_tick = -1;
+
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+    unsigned char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        player.bytes.insert(player.bytes.end(), buffer, buffer + read);
+    fclose(file);
+
+    uint64_t version, reserved, hz, seed;
+    bool ok = player.bytes.size() >= 4 && memcmp(player.bytes.data(), "PMRC", 4) == 0;
+    player.cursor = 4;
+    ok = ok && ReadRecordUint(player, 1, version) && ReadRecordUint(player, 1, reserved) &&
+         ReadRecordUint(player, 2, hz) && ReadRecordUint(player, 4, seed);
+    if (!ok || version != INPUT_RECORD_VERSION || hz != (uint64_t)SIMULATION_HZ)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not a %d Hz input recording (version %d).\n", filename, (int)SIMULATION_HZ, INPUT_RECORD_VERSION);
+        return false;
+    }
+    player.seed = (uint32_t)seed;
+
+    if (!ReadNextInputRecord(player))
+    {
+        fprintf(stderr, "ERROR: Malformed input recording \"%s\".\n", filename);
+        return false;
+    }
+    player.active = true;
+    return true;
+}
+
+// Entrada do próximo passo. Retorna false quando a gravação terminou (ou
+// está corrompida).
+bool NextReplayInput(InputPlayer &player, RecordedInput &input)
+{
+    if (!player.active)
+        return false;
+
+    if (player.tick == player.next_tick)
+    {
+        player.current = player.next;
+        if (!ReadNextInputRecord(player))
+        {
+            fprintf(stderr, "ERROR: Malformed input recording \"%s\" at tick %lld.\n", player.filename.c_str(), player.tick);
+            player.active = false;
+            return false;
+        }
+    }
+    if (player.next_tick < 0 && player.tick >= player.total_ticks)
+    {
+        player.active = false;
+        return false;
+    }
+
+    input = player.current;
+    player.current.restart = false; // O reinício vale só para o passo do registro
+    player.tick += 1;
+    return true;
+}
+
+// Compara o estado ao fim da reprodução com o gravado.
+bool FinishInputReplay(const InputPlayer &player, uint64_t checksum)
+{
+    bool match = checksum == player.checksum && player.tick == player.total_ticks;
+    fprintf(match ? stdout : stderr, "Replay \"%s\": %lld de %lld passos, checksum %016llx (gravado %016llx): %s\n",
+            player.filename.c_str(), player.tick, player.total_ticks, (unsigned long long)checksum,
+            (unsigned long long)player.checksum, match ? "OK" : "DIVERGIU");
+    fflush(match ? stdout : stderr);
+    return match;
+}
@@ -0,0 +1,502 @@
+#pragma once
+
+// Formato de fase: paredes, bolinhas, cerejas e posições iniciais dos
+// fantasmas lidos de um arquivo, no lugar das tabelas fixas no código.
+//
+// A fonte é um texto (resources/levels/*.lvl) com uma diretiva por linha;
+// "#" começa um comentário até o fim da linha:
+//
+//     bounds <min_x> <min_z> <max_x> <max_z>      região dos fantasmas (grade de navegação)
+//     wall <tx> <ty> <tz> <sx> <sy> <sz> <malha> <tipo>
+//     mirrored_wall <mesmos campos>               também em (-tx, tz), (tx, -tz) e (-tx, -tz)
+//     pellet <x> <y> <z> <raio>
+//     pellets <n> <dx> <dz> <raio> <x y z>...     n passos a partir de cada ponto, intercalados
+//     cherry <x> <y> <z> <raio>
+//     ghost <FIRST|SECOND> <x> <y> <z>
+//
+// <malha> é um objeto de g_VirtualScene (p2, p22, p3, p33) e <tipo> o
+// identificador do Fragment Shader (LABYRINTH_1 a LABYRINTH_3).
+//
+// CompileLevel() traduz o texto para o formato binário: um LevelHeader
+// seguido dos arrays de registros de tamanho fixo, nessa ordem. O binário
+// é usado direto da memória (LevelView aponta para dentro dele) e pode ser
+// salvo e carregado sem a etapa de compilação (veja src/level_compiler.cpp).
+// O arquivo lido, texto ou binário, e o binário compilado ficam numa única
+// LevelArena reservada na inicialização: carregar uma fase não faz nenhuma
+// outra alocação. Os números são gravados na ordem de bytes da máquina.
+
+// "headers" padrões de C
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Headers específicos de C++
+#include <vector>
+
+const char LEVEL_MAGIC[4] = {'P', 'M', 'L', 'V'};
+const uint32_t LEVEL_VERSION = 1;
+
+// Espaço da arena de fases, em bytes: sobra para o arquivo de texto e o
+// binário de fases com centenas de milhares de registros.
+const size_t LEVEL_ARENA_SIZE = 16u << 20;
+
+const char *DEFAULT_LEVEL_FILE = "../../resources/levels/classic.lvl";
+
+// Pontos de partida por diretiva "pellets"
+const int LEVEL_MAX_PELLET_STARTS = 8;
+
+struct LevelHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size; // Bytes do binário, incluindo este cabeçalho
+    float bounds_min_x, bounds_min_z, bounds_max_x, bounds_max_z;
+    uint32_t wall_count, pellet_count, cherry_count, ghost_count;
+};
+
+struct LevelWall
+{
+    float translate[3];
+    float scale[3];
+    int32_t object_type;
+    char mesh[12]; // Nome em g_VirtualScene, terminado em '\0'
+};
+
+struct LevelPellet
+{
+    float x, y, z, radius;
+};
+
+struct LevelCherry
+{
+    float x, y, z, radius;
+};
+
+struct LevelGhost
+{
+    int32_t type; // GhostType
+    float x, y, z;
+};
+
+// Ponteiros para as partes de um binário de fase
+struct LevelView
+{
+    const LevelHeader *header = NULL;
+    const LevelWall *walls = NULL;
+    const LevelPellet *pellets = NULL;
+    const LevelCherry *cherries = NULL;
+    const LevelGhost *ghosts = NULL;
+};
+
+struct LevelArena
+{
+    std::vector<uint8_t> memory;
+    size_t used = 0;
+};
+
+LevelArena g_LevelArena;
+LevelView g_Level;
+
+void InitLevelArena(LevelArena &arena, size_t capacity)
+{
+    arena.memory.assign(capacity, 0);
+    arena.used = 0;
+}
+
+// Blocos alinhados a 8 bytes; NULL se a arena não comporta "size".
+void *LevelArenaAllocate(LevelArena &arena, size_t size)
+{
+    size_t begin = (arena.used + 7) & ~(size_t)7;
+    if (begin + size > arena.memory.size())
+        return NULL;
+    arena.used = begin + size;
+    return arena.memory.data() + begin;
+}
+
+size_t LevelBlobSize(uint32_t walls, uint32_t pellets, uint32_t cherries, uint32_t ghosts)
+{
+    return sizeof(LevelHeader) + walls * sizeof(LevelWall) + pellets * sizeof(LevelPellet) +
+           cherries * sizeof(LevelCherry) + ghosts * sizeof(LevelGhost);
+}
+
+// Confere o cabeçalho, os tamanhos e os nomes das malhas (terminados em
+// '\0' dentro do campo) de um binário e preenche "level".
+bool ViewLevelBlob(const void *data, size_t size, LevelView &level)
+{
+    const LevelHeader *header = (const LevelHeader *)data;
+    if (size < sizeof(LevelHeader) || memcmp(header->magic, LEVEL_MAGIC, 4) != 0 || header->version != LEVEL_VERSION)
+        return false;
+    if (header->size > size || header->size != LevelBlobSize(header->wall_count, header->pellet_count, header->cherry_count, header->ghost_count))
+        return false;
+
+    const uint8_t *cursor = (const uint8_t *)data + sizeof(LevelHeader);
+    level.header = header;
+    level.walls = (const LevelWall *)cursor;
+    cursor += header->wall_count * sizeof(LevelWall);
+    level.pellets = (const LevelPellet *)cursor;
+    cursor += header->pellet_count * sizeof(LevelPellet);
+    level.cherries = (const LevelCherry *)cursor;
+    cursor += header->cherry_count * sizeof(LevelCherry);
+    level.ghosts = (const LevelGhost *)cursor;
+
+    for (uint32_t i = 0; i < header->wall_count; ++i)
+        if (memchr(level.walls[i].mesh, 0, sizeof(level.walls[i].mesh)) == NULL)
+            return false;
+    return true;
+}
+
+// Leitura do texto, uma linha por vez. Os tokens apontam para o próprio
+// texto; nada é copiado.
+struct LevelParser
+{
+    const char *filename;
+    const char *cursor;
+    const char *end;
+    int line;
+
+    const char *token; // Token atual, com "token_length" caracteres
+    int token_length;
+};
+
+// Próximo token da linha atual; false no fim da linha ou do texto.
+bool NextLevelToken(LevelParser &parser)
+{
+    while (parser.cursor < parser.end && (*parser.cursor == ' ' || *parser.cursor == '\t' || *parser.cursor == '\r'))
+        parser.cursor++;
+    if (parser.cursor < parser.end && *parser.cursor == '#')
+    {
+        while (parser.cursor < parser.end && *parser.cursor != '\n')
+            parser.cursor++;
+    }
+    if (parser.cursor >= parser.end || *parser.cursor == '\n')
+        return false;
+
+    parser.token = parser.cursor;
+    while (parser.cursor < parser.end && *parser.cursor != ' ' && *parser.cursor != '\t' &&
+           *parser.cursor != '\r' && *parser.cursor != '\n' && *parser.cursor != '#')
+        parser.cursor++;
+    parser.token_length = (int)(parser.cursor - parser.token);
+    return true;
+}
+
+// Avança para o início da próxima linha; false no fim do texto.
+bool NextLevelLine(LevelParser &parser)
+{
+    while (parser.cursor < parser.end && *parser.cursor != '\n')
+        parser.cursor++;
+    if (parser.cursor >= parser.end)
+        return false;
+    parser.cursor++;
+    parser.line++;
+    return true;
+}
+
+bool LevelTokenIs(const LevelParser &parser, const char *word)
+{
+    return (int)strlen(word) == parser.token_length && strncmp(parser.token, word, parser.token_length) == 0;
+}
+
+bool LevelError(const LevelParser &parser, const char *message)
+{
+    fprintf(stderr, "%s:%d: %s\n", parser.filename, parser.line, message);
+    return false;
+}
+
+bool ParseLevelFloat(LevelParser &parser, float &value)
+{
+    if (!NextLevelToken(parser))
+        return LevelError(parser, "número esperado");
+    char *number_end;
+    value = strtof(parser.token, &number_end);
+    if (number_end != parser.token + parser.token_length)
+        return LevelError(parser, "número inválido");
+    return true;
+}
+
+bool ParseLevelInt(LevelParser &parser, int &value)
+{
+    if (!NextLevelToken(parser))
+        return LevelError(parser, "número inteiro esperado");
+    char *number_end;
+    value = (int)strtol(parser.token, &number_end, 10);
+    if (number_end != parser.token + parser.token_length)
+        return LevelError(parser, "número inteiro inválido");
+    return true;
+}
+
+// Nomes aceitos em <tipo> (veja globals.hpp) e em "ghost"
+struct LevelName
+{
+    const char *name;
+    int value;
+};
+
+const LevelName LEVEL_OBJECT_TYPES[] = {{"LABYRINTH_1", 1}, {"LABYRINTH_2", 2}, {"LABYRINTH_3", 3}};
+const LevelName LEVEL_GHOST_TYPES[] = {{"FIRST", 0}, {"SECOND", 1}};
+
+template <size_t N>
+bool ParseLevelName(LevelParser &parser, const LevelName (&names)[N], int &value)
+{
+    if (!NextLevelToken(parser))
+        return LevelError(parser, "nome esperado");
+    for (const LevelName &name : names)
+    {
+        if (LevelTokenIs(parser, name.name))
+        {
+            value = name.value;
+            return true;
+        }
+    }
+    return LevelError(parser, "nome desconhecido");
+}
+
+// Percorre o texto inteiro. Com "out" nulo só valida e conta os registros
+// em "header"; caso contrário também os escreve nos arrays de "out", já
+// dimensionados pela primeira passada.
+bool ParseLevelSource(LevelParser parser, LevelHeader &header, LevelWall *walls, LevelPellet *pellets,
+                      LevelCherry *cherries, LevelGhost *ghosts)
+{
+    bool emit = walls != NULL;
+    header.wall_count = header.pellet_count = header.cherry_count = header.ghost_count = 0;
+
+    do
+    {
+        if (!NextLevelToken(parser))
+            continue;
+
+        if (LevelTokenIs(parser, "bounds"))
+        {
+            if (!ParseLevelFloat(parser, header.bounds_min_x) || !ParseLevelFloat(parser, header.bounds_min_z) ||
+                !ParseLevelFloat(parser, header.bounds_max_x) || !ParseLevelFloat(parser, header.bounds_max_z))
+                return false;
+        }
+        else if (LevelTokenIs(parser, "wall") || LevelTokenIs(parser, "mirrored_wall"))
+        {
+            bool mirrored = LevelTokenIs(parser, "mirrored_wall");
+            LevelWall wall = {};
+            for (int i = 0; i < 3; ++i)
+                if (!ParseLevelFloat(parser, wall.translate[i]))
+                    return false;
+            for (int i = 0; i < 3; ++i)
+                if (!ParseLevelFloat(parser, wall.scale[i]))
+                    return false;
+            if (!NextLevelToken(parser))
+                return LevelError(parser, "nome da malha esperado");
+            if (parser.token_length >= (int)sizeof(wall.mesh))
+                return LevelError(parser, "nome da malha muito longo");
+            memcpy(wall.mesh, parser.token, parser.token_length);
+            int object_type;
+            if (!ParseLevelName(parser, LEVEL_OBJECT_TYPES, object_type))
+                return false;
+            wall.object_type = object_type;
+
+            // Mesma ordem das paredes espelhadas do labirinto original
+            float tx = wall.translate[0], tz = wall.translate[2];
+            float mirrors[4][2] = {{tx, tz}, {-tx, tz}, {tx, -tz}, {-tx, -tz}};
+            bool used[4] = {true, mirrored && tx != 0.0f, mirrored && tz != 0.0f, mirrored && tx != 0.0f && tz != 0.0f};
+            for (int m = 0; m < 4; ++m)
+            {
+                if (!used[m])
+                    continue;
+                if (emit)
+                {
+                    walls[header.wall_count] = wall;
+                    walls[header.wall_count].translate[0] = mirrors[m][0];
+                    walls[header.wall_count].translate[2] = mirrors[m][1];
+                }
+                header.wall_count++;
+            }
+        }
+        else if (LevelTokenIs(parser, "pellet"))
+        {
+            LevelPellet pellet;
+            if (!ParseLevelFloat(parser, pellet.x) || !ParseLevelFloat(parser, pellet.y) ||
+                !ParseLevelFloat(parser, pellet.z) || !ParseLevelFloat(parser, pellet.radius))
+                return false;
+            if (emit)
+                pellets[header.pellet_count] = pellet;
+            header.pellet_count++;
+        }
+        else if (LevelTokenIs(parser, "pellets"))
+        {
+            int count;
+            float dx, dz, radius;
+            if (!ParseLevelInt(parser, count) || !ParseLevelFloat(parser, dx) || !ParseLevelFloat(parser, dz) ||
+                !ParseLevelFloat(parser, radius))
+                return false;
+            if (count < 0)
+                return LevelError(parser, "número de passos negativo");
+
+            LevelPellet starts[LEVEL_MAX_PELLET_STARTS];
+            int start_count = 0;
+            const char *before = parser.cursor;
+            while (NextLevelToken(parser))
+            {
+                parser.cursor = before;
+                if (start_count == LEVEL_MAX_PELLET_STARTS)
+                    return LevelError(parser, "pontos de partida demais");
+                LevelPellet &start = starts[start_count++];
+                if (!ParseLevelFloat(parser, start.x) || !ParseLevelFloat(parser, start.y) || !ParseLevelFloat(parser, start.z))
+                    return false;
+                start.radius = radius;
+                before = parser.cursor;
+            }
+            if (start_count == 0)
+                return LevelError(parser, "ponto de partida esperado");
+
+            // Soma passo a passo, como os laços que geravam as bolinhas
+            for (int step = 0; step < count; ++step)
+            {
+                for (int s = 0; s < start_count; ++s)
+                {
+                    if (emit)
+                        pellets[header.pellet_count] = starts[s];
+                    header.pellet_count++;
+                    starts[s].x += dx;
+                    starts[s].z += dz;
+                }
+            }
+        }
+        else if (LevelTokenIs(parser, "cherry"))
+        {
+            LevelCherry cherry;
+            if (!ParseLevelFloat(parser, cherry.x) || !ParseLevelFloat(parser, cherry.y) ||
+                !ParseLevelFloat(parser, cherry.z) || !ParseLevelFloat(parser, cherry.radius))
+                return false;
+            if (emit)
+                cherries[header.cherry_count] = cherry;
+            header.cherry_count++;
+        }
+        else if (LevelTokenIs(parser, "ghost"))
+        {
+            LevelGhost ghost;
+            int type;
+            if (!ParseLevelName(parser, LEVEL_GHOST_TYPES, type) || !ParseLevelFloat(parser, ghost.x) ||
+                !ParseLevelFloat(parser, ghost.y) || !ParseLevelFloat(parser, ghost.z))
+                return false;
+            ghost.type = type;
+            if (emit)
+                ghosts[header.ghost_count] = ghost;
+            header.ghost_count++;
+        }
+        else
+        {
+            return LevelError(parser, "diretiva desconhecida");
+        }
+
+        if (NextLevelToken(parser))
+            return LevelError(parser, "campos demais");
+    } while (NextLevelLine(parser));
+
+    return true;
+}
+
+// Compila o texto [text, text + length) para um binário alocado na arena.
+bool CompileLevel(LevelArena &arena, const char *filename, const char *text, size_t length, LevelView &level)
+{
+    LevelParser parser = {filename, text, text + length, 1, NULL, 0};
+    LevelHeader header = {};
+    memcpy(header.magic, LEVEL_MAGIC, 4);
+    header.version = LEVEL_VERSION;
+    header.bounds_min_x = header.bounds_min_z = -9.0f;
+    header.bounds_max_x = header.bounds_max_z = 9.0f;
+    if (!ParseLevelSource(parser, header, NULL, NULL, NULL, NULL))
+        return false;
+
+    header.size = (uint32_t)LevelBlobSize(header.wall_count, header.pellet_count, header.cherry_count, header.ghost_count);
+    uint8_t *blob = (uint8_t *)LevelArenaAllocate(arena, header.size);
+    if (blob == NULL)
+    {
+        fprintf(stderr, "%s: fase grande demais para a arena (%u bytes)\n", filename, header.size);
+        return false;
+    }
+
+    memset(blob, 0, header.size);
+    memcpy(blob, &header, sizeof(header));
+    ViewLevelBlob(blob, header.size, level);
+    return ParseLevelSource(parser, *(LevelHeader *)blob, (LevelWall *)level.walls, (LevelPellet *)level.pellets,
+                            (LevelCherry *)level.cherries, (LevelGhost *)level.ghosts);
+}
+
+// Diz se uma malha existe; o jogo passa uma que consulta g_VirtualScene.
+typedef bool (*LevelMeshCheck)(const char *mesh);
+
+// Problemas que o formato aceita, mas que tornariam a fase injogável: sem
+// bolinhas o jogo seria vencido a cada passo, e uma parede com malha
+// desconhecida não teria forma.
+bool ValidateLevel(const char *filename, const LevelView &level, LevelMeshCheck mesh_exists)
+{
+    if (level.header->pellet_count == 0)
+    {
+        fprintf(stderr, "Fase \"%s\": nenhuma bolinha\n", filename);
+        return false;
+    }
+    for (uint32_t i = 0; mesh_exists != NULL && i < level.header->wall_count; ++i)
+    {
+        if (!mesh_exists(level.walls[i].mesh))
+        {
+            fprintf(stderr, "Fase \"%s\": parede %u usa a malha \"%s\", que não foi carregada\n", filename, i,
+                    level.walls[i].mesh);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Carrega "filename" na arena, que é esvaziada antes. Um binário (começa com
+// LEVEL_MAGIC) é usado como está; qualquer outro arquivo é compilado. Com
+// "mesh_exists", as malhas das paredes também são conferidas.
+bool LoadLevel(LevelArena &arena, const char *filename, LevelView &level, LevelMeshCheck mesh_exists = NULL)
+{
+    if (arena.memory.empty())
+        InitLevelArena(arena, LEVEL_ARENA_SIZE);
+    arena.used = 0;
+
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Não foi possível abrir a fase \"%s\"\n", filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *data = size >= 0 ? (char *)LevelArenaAllocate(arena, (size_t)size + 1) : NULL;
+    bool read = data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!read)
+    {
+        fprintf(stderr, "Não foi possível ler a fase \"%s\" (%ld bytes)\n", filename, size);
+        return false;
+    }
+    data[size] = '\0';
+
+    if (size >= 4 && memcmp(data, LEVEL_MAGIC, 4) == 0)
+    {
+        if (!ViewLevelBlob(data, (size_t)size, level))
+        {
+            fprintf(stderr, "Fase \"%s\": binário inválido ou de outra versão\n", filename);
+            return false;
+        }
+    }
+    else if (!CompileLevel(arena, filename, data, (size_t)size, level))
+    {
+        return false;
+    }
+    return ValidateLevel(filename, level, mesh_exists);
+}
+
+bool SaveLevelBlob(const LevelView &level, const char *filename)
+{
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Não foi possível criar \"%s\"\n", filename);
+        return false;
+    }
+    bool written = fwrite(level.header, 1, level.header->size, file) == level.header->size;
+    fclose(file);
+    return written;
+}
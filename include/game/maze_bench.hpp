@@ -0,0 +1,186 @@
+#pragma once
+
+// Benchmark de escala ("pacman_headless --maze-bench"): gera labirintos de
+// maze_generator.hpp de tamanhos crescentes e mede, para cada um, o custo de
+// montar o mundo, de um passo de simulação e de cada consulta que depende do
+// tamanho da arena: bolinhas e paredes perto do Pac-Man, campo de fluxo dos
+// fantasmas, colisão com todos os fantasmas e o teste de visibilidade dos
+// pacotes de desenho (render_packets.hpp) com uma câmera de cima. Uma linha
+// por tamanho é escrita em formato CSV, pronta para um gráfico.
+//
+// O custo de desenho na GPU não é medido aqui (não há contexto OpenGL); o
+// jogo aceita os mesmos labirintos com "./main --maze N", e o painel de
+// estatísticas (tecla H) mostra o tempo de cada etapa e as chamadas de desenho.
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <external/glm/mat4x4.hpp>
+#include <external/glm/vec4.hpp>
+
+#include "matrices.h"
+#include "game/simulation.hpp"
+#include "game/maze_generator.hpp"
+#include "objects/render_packets.hpp"
+#include "utils/job_system.hpp"
+
+const int MAZE_BENCH_SIZES[] = {20, 50, 100, 200, 500, 1000, 2000};
+
+// Passos simulados por tamanho, ou menos se MAZE_BENCH_SECONDS se esgotar
+const int MAZE_BENCH_TICKS = 240;
+const double MAZE_BENCH_SECONDS = 2.0;
+
+// Consultas de cada tipo por tamanho, em pontos sorteados da arena
+const int MAZE_BENCH_QUERIES = 2000;
+const int MAZE_BENCH_FLOW_FIELDS = 8;
+const int MAZE_BENCH_CULL_FRAMES = 8;
+
+typedef std::chrono::steady_clock MazeBenchClock;
+
+double MazeBenchMicroseconds(MazeBenchClock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(MazeBenchClock::now() - start).count();
+}
+
+void RunMazeBenchmarks(int max_cells, uint32_t seed, const char *csv_file)
+{
+    FILE *csv = fopen(csv_file, "w");
+    if (csv == NULL)
+    {
+        fprintf(stderr, "Não foi possível criar \"%s\"\n", csv_file);
+        return;
+    }
+
+    const char *columns = "cells,walls,pellets,ghosts,generate_ms,setup_ms,tick_us,pellet_query_us,"
+                          "wall_sweep_us,flow_field_us,ghost_hit_us,cull_us,visible_packets";
+    fprintf(csv, "%s\n", columns);
+    printf("Maze benchmark (semente %u, %d threads trabalhadoras)\n", seed, JobWorkerCount());
+    printf("%6s %8s %8s %6s %9s %9s %9s %8s %8s %10s %9s %9s %8s\n", "cells", "walls", "pellets", "ghosts",
+           "gen ms", "setup ms", "tick us", "pellet", "sweep", "flow us", "ghost us", "cull us", "visible");
+
+    for (int cells : MAZE_BENCH_SIZES)
+    {
+        if (cells > max_cells)
+            break;
+
+        MazeBenchClock::time_point start = MazeBenchClock::now();
+        if (!GenerateMazeLevel(g_LevelArena, cells, seed, g_Level))
+            break;
+        double generate_ms = MazeBenchMicroseconds(start) / 1000.0;
+
+        start = MazeBenchClock::now();
+        InitializeWorld();
+        double setup_ms = MazeBenchMicroseconds(start) / 1000.0;
+
+        // Sem a animação de entrada: o Pac-Man começa no chão, já jogando
+        t = 2.0f;
+        pacman_position_c = pacman_previous_position = final_position_bezier;
+
+        // Passos de simulação andando em uma direção sorteada a cada meio segundo
+        uint32_t state = seed;
+        PacmanInput input = {};
+        input.forward_unit = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+        input.side_unit = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+        int ticks = 0;
+        start = MazeBenchClock::now();
+        while (ticks < MAZE_BENCH_TICKS && MazeBenchMicroseconds(start) < MAZE_BENCH_SECONDS * 1e6)
+        {
+            if (ticks % (int)(SIMULATION_HZ / 2) == 0)
+            {
+                uint32_t keys = NextMazeRandom(state);
+                input.forward = keys % 4 == 0;
+                input.backward = keys % 4 == 1;
+                input.right = keys / 4 % 4 == 0;
+                input.left = keys / 4 % 4 == 1;
+            }
+            SimulationTick(input);
+            ticks++;
+        }
+        double tick_us = MazeBenchMicroseconds(start) / ticks;
+
+        // Pontos de consulta: centros de células sorteadas
+        const LevelHeader &header = *g_Level.header;
+        std::vector<glm::vec3> points(MAZE_BENCH_QUERIES);
+        for (glm::vec3 &point : points)
+        {
+            float x = header.bounds_min_x + 0.5f + (float)(NextMazeRandom(state) % (uint32_t)cells);
+            float z = header.bounds_min_z + 0.5f + (float)(NextMazeRandom(state) % (uint32_t)cells);
+            point = glm::vec3(x, pacman_position_c.y, z);
+        }
+        float radius = pacman_size + 0.1f;
+
+        std::vector<int> hits;
+        start = MazeBenchClock::now();
+        for (const glm::vec3 &point : points)
+        {
+            hits.clear();
+            FindPelletsTouching(g_PelletGrid, pellets, Sphere{point, radius}, hits);
+        }
+        double pellet_query_us = MazeBenchMicroseconds(start) / points.size();
+
+        volatile float sink = 0.0f;
+        start = MazeBenchClock::now();
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            glm::vec3 displacement = i % 2 == 0 ? glm::vec3(0.05f, 0.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 0.05f);
+            sink = sink + moveSphereThroughWalls(Sphere{points[i], radius}, displacement).x;
+        }
+        double wall_sweep_us = MazeBenchMicroseconds(start) / points.size();
+
+        start = MazeBenchClock::now();
+        for (int i = 0; i < MAZE_BENCH_FLOW_FIELDS; ++i)
+            UpdateFlowField(g_NavGrid, NavCellAt(g_NavGrid, points[i]));
+        double flow_field_us = MazeBenchMicroseconds(start) / MAZE_BENCH_FLOW_FIELDS;
+
+        freeze_ghosts_countdown = 0.0f;
+        int caught = 0;
+        start = MazeBenchClock::now();
+        for (int i = 0; i < MAZE_BENCH_QUERIES / 10; ++i)
+            caught += GhostsCaughtPacman(ghosts, Sphere{points[i], radius}) ? 1 : 0;
+        double ghost_hit_us = MazeBenchMicroseconds(start) / (MAZE_BENCH_QUERIES / 10);
+
+        // Mesma montagem de pacotes do jogo, com a câmera sobre o Pac-Man
+        RenderPacketList wall_packets, ghost_packets;
+        int visible = 0;
+        start = MazeBenchClock::now();
+        for (int frame = 0; frame < MAZE_BENCH_CULL_FRAMES; ++frame)
+        {
+            glm::vec4 target = glm::vec4(points[frame], 1.0f);
+            glm::vec4 camera = target + glm::vec4(0.0f, 15.0f, 5.0f, 0.0f);
+            glm::mat4 view = Matrix_Camera_View(camera, target - camera, glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+            glm::mat4 projection = Matrix_Perspective(3.141592f / 3.0f, 16.0f / 9.0f, -0.1f, -40.0f);
+            Frustum frustum = ExtractFrustum(projection * view);
+
+            ResizeRenderPackets(wall_packets, (int)walls.model.size());
+            ParallelFor("BuildWallPackets", (int)walls.model.size(), RENDER_PACKET_JOB_GRAIN, [&](int begin, int end)
+                        { BuildWallPackets(walls, frustum, wall_packets, begin, end); });
+            ResizeRenderPackets(ghost_packets, GhostCount(ghosts));
+            ParallelFor("BuildGhostPackets", GhostCount(ghosts), RENDER_PACKET_JOB_GRAIN, [&](int begin, int end)
+                        { BuildGhostPackets(ghosts, 1.0f, frustum, ghost_packets, begin, end); });
+
+            visible += (int)std::count(wall_packets.visible.begin(), wall_packets.visible.end(), 1);
+            visible += (int)std::count(ghost_packets.visible.begin(), ghost_packets.visible.end(), 1);
+        }
+        double cull_us = MazeBenchMicroseconds(start) / MAZE_BENCH_CULL_FRAMES;
+        visible /= MAZE_BENCH_CULL_FRAMES;
+
+        int wall_count = (int)walls.model.size();
+        int pellet_count = initial_ball_count;
+        int ghost_total = GhostCount(ghosts);
+        printf("%6d %8d %8d %6d %9.1f %9.1f %9.2f %8.3f %8.3f %10.1f %9.2f %9.1f %8d\n", cells, wall_count,
+               pellet_count, ghost_total, generate_ms, setup_ms, tick_us, pellet_query_us, wall_sweep_us,
+               flow_field_us, ghost_hit_us, cull_us, visible);
+        fprintf(csv, "%d,%d,%d,%d,%.3f,%.3f,%.3f,%.4f,%.4f,%.3f,%.3f,%.3f,%d\n", cells, wall_count, pellet_count,
+                ghost_total, generate_ms, setup_ms, tick_us, pellet_query_us, wall_sweep_us, flow_field_us,
+                ghost_hit_us, cull_us, visible);
+        fflush(csv);
+        fflush(stdout);
+        (void)caught;
+    }
+
+    fclose(csv);
+    printf("Resultados em \"%s\"\n", csv_file);
+}
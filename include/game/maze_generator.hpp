@@ -0,0 +1,267 @@
+#pragma once
+
+// Gerador procedural de labirintos para testar o jogo em arenas grandes.
+//
+// GenerateMazeLevel() cria, com uma semente, um labirinto de N x N células
+// (de 20 x 20 a 2000 x 2000) no mesmo formato binário de level.hpp: o
+// resultado passa pelo mesmo caminho de uma fase lida de arquivo
+// (InitializeWorld(), instanciateWalls(), instanciateLittleBalls(), ...).
+// A mesma semente e o mesmo tamanho produzem sempre o mesmo labirinto.
+//
+// O labirinto é gerado pelo algoritmo "sidewinder", linha a linha, e depois
+// algumas paredes internas são removidas ao acaso para criar ciclos, como
+// nos corredores do Pac-Man. Cada célula tem MAZE_CELL_SIZE de lado e uma
+// bolinha no centro; os centros caem em coordenadas inteiras, então o ponto
+// onde a animação de entrada deixa o Pac-Man, (0, -1), é sempre o centro de
+// uma célula. As paredes alinhadas e contíguas viram uma única caixa.
+
+// "headers" padrões de C
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// Headers específicos de C++
+#include <vector>
+#include <algorithm>
+
+#include <external/glm/vec3.hpp>
+
+#include "objects/objects.hpp"
+#include "game/level.hpp"
+
+const int MAZE_MIN_CELLS = 20;
+const int MAZE_MAX_CELLS = 2000;
+const float MAZE_CELL_SIZE = 1.0f;
+const float MAZE_WALL_THICKNESS = 0.1f;
+
+// Uma parede interna em MAZE_LOOP_CHANCE é removida depois do sidewinder
+const uint32_t MAZE_LOOP_CHANCE = 8;
+
+// Um fantasma a cada MAZE_CELLS_PER_GHOST células (no mínimo dois), longe
+// do ponto de partida do Pac-Man
+const int MAZE_CELLS_PER_GHOST = 200;
+const int MAZE_GHOST_SAFE_CELLS = 4;
+
+// Malha usada por todas as paredes, com a mesma altura das do labirinto
+// original (translação y = -1, escala y = 0.5)
+const char *MAZE_WALL_MESH = "p2";
+
+enum MazeCellWalls
+{
+    MAZE_WALL_EAST = 1,
+    MAZE_WALL_NORTH = 2
+};
+
+uint32_t NextMazeRandom(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+struct MazeLayout
+{
+    int cells;
+    float origin;                // Coordenada x e z da primeira aresta
+    std::vector<uint8_t> walls;  // MazeCellWalls de cada célula, linha a linha
+};
+
+void CarveMaze(MazeLayout &maze, uint32_t seed)
+{
+    const int n = maze.cells;
+    maze.origin = -(float)(n / 2) - 0.5f * MAZE_CELL_SIZE;
+    maze.walls.assign((size_t)n * n, MAZE_WALL_EAST | MAZE_WALL_NORTH);
+
+    uint32_t state = seed;
+    for (int row = 0; row < n; ++row)
+    {
+        uint8_t *cells = &maze.walls[(size_t)row * n];
+        int run_start = 0;
+        for (int column = 0; column < n; ++column)
+        {
+            bool last_column = column == n - 1;
+            if (row == 0)
+            {
+                // A primeira linha é um corredor só; não há para onde subir
+                if (!last_column)
+                    cells[column] &= ~MAZE_WALL_EAST;
+            }
+            else if (!last_column && NextMazeRandom(state) % 2 == 0)
+            {
+                cells[column] &= ~MAZE_WALL_EAST;
+            }
+            else
+            {
+                int opening = run_start + (int)(NextMazeRandom(state) % (uint32_t)(column - run_start + 1));
+                cells[opening] &= ~MAZE_WALL_NORTH;
+                run_start = column + 1;
+            }
+        }
+    }
+
+    // Ciclos: o sidewinder gera um labirinto perfeito, com um único caminho
+    // entre duas células
+    for (int row = 0; row < n; ++row)
+    {
+        for (int column = 0; column < n; ++column)
+        {
+            uint8_t &cell = maze.walls[(size_t)row * n + column];
+            if (column < n - 1 && (cell & MAZE_WALL_EAST) && NextMazeRandom(state) % MAZE_LOOP_CHANCE == 0)
+                cell &= ~MAZE_WALL_EAST;
+            if (row > 0 && (cell & MAZE_WALL_NORTH) && NextMazeRandom(state) % MAZE_LOOP_CHANCE == 0)
+                cell &= ~MAZE_WALL_NORTH;
+        }
+    }
+}
+
+// Há parede na aresta "index" da linha de arestas "line"? As linhas
+// horizontais separam as linhas de células line - 1 e line; as verticais,
+// as colunas line - 1 e line. As bordas são sempre fechadas.
+bool MazeEdgeClosed(const MazeLayout &maze, bool horizontal, int line, int index)
+{
+    const int n = maze.cells;
+    if (line == 0 || line == n)
+        return true;
+    if (horizontal)
+        return maze.walls[(size_t)line * n + index] & MAZE_WALL_NORTH;
+    return maze.walls[(size_t)index * n + line - 1] & MAZE_WALL_EAST;
+}
+
+// Percorre as caixas das paredes, juntando as arestas fechadas contíguas de
+// cada linha, e chama emit(min_x, min_z, max_x, max_z) para cada uma.
+template <typename Emit>
+void ForEachMazeWall(const MazeLayout &maze, Emit emit)
+{
+    const int n = maze.cells;
+    const float half = MAZE_WALL_THICKNESS / 2.0f;
+    for (int horizontal = 1; horizontal >= 0; --horizontal)
+    {
+        for (int line = 0; line <= n; ++line)
+        {
+            float across = maze.origin + line * MAZE_CELL_SIZE;
+            int index = 0;
+            while (index < n)
+            {
+                if (!MazeEdgeClosed(maze, horizontal, line, index))
+                {
+                    index++;
+                    continue;
+                }
+                int first = index;
+                while (index < n && MazeEdgeClosed(maze, horizontal, line, index))
+                    index++;
+
+                float along_min = maze.origin + first * MAZE_CELL_SIZE - half;
+                float along_max = maze.origin + index * MAZE_CELL_SIZE + half;
+                if (horizontal)
+                    emit(along_min, across - half, along_max, across + half);
+                else
+                    emit(across - half, along_min, across + half, along_max);
+            }
+        }
+    }
+}
+
+glm::vec3 MazeCellCenter(const MazeLayout &maze, int column, int row, float y)
+{
+    return glm::vec3(maze.origin + (column + 0.5f) * MAZE_CELL_SIZE, y, maze.origin + (row + 0.5f) * MAZE_CELL_SIZE);
+}
+
+// Gera o labirinto na arena (que é esvaziada e, se preciso, aumentada) e
+// preenche "level". As paredes precisam da AABB de MAZE_WALL_MESH em
+// g_VirtualScene (veja LoadLabyrinthObjects()).
+bool GenerateMazeLevel(LevelArena &arena, int cells, uint32_t seed, LevelView &level)
+{
+    if (cells < MAZE_MIN_CELLS || cells > MAZE_MAX_CELLS)
+    {
+        fprintf(stderr, "Labirinto: o tamanho deve estar entre %d e %d células\n", MAZE_MIN_CELLS, MAZE_MAX_CELLS);
+        return false;
+    }
+    if (g_VirtualScene.count(MAZE_WALL_MESH) == 0)
+    {
+        fprintf(stderr, "Labirinto: malha \"%s\" não carregada\n", MAZE_WALL_MESH);
+        return false;
+    }
+    const SceneObject &mesh = g_VirtualScene[MAZE_WALL_MESH];
+
+    MazeLayout maze;
+    maze.cells = cells;
+    CarveMaze(maze, seed);
+
+    uint32_t wall_count = 0;
+    ForEachMazeWall(maze, [&wall_count](float, float, float, float)
+                    { wall_count++; });
+    uint32_t pellet_count = (uint32_t)cells * (uint32_t)cells;
+    uint32_t cherry_count = 4;
+    uint32_t ghost_count = std::max<uint32_t>(2, pellet_count / MAZE_CELLS_PER_GHOST);
+
+    size_t size = LevelBlobSize(wall_count, pellet_count, cherry_count, ghost_count);
+    if (arena.memory.size() < size + 8)
+        InitLevelArena(arena, std::max(size + 8, LEVEL_ARENA_SIZE));
+    arena.used = 0;
+    uint8_t *blob = (uint8_t *)LevelArenaAllocate(arena, size);
+    memset(blob, 0, size);
+
+    LevelHeader header = {};
+    memcpy(header.magic, LEVEL_MAGIC, 4);
+    header.version = LEVEL_VERSION;
+    header.size = (uint32_t)size;
+    header.bounds_min_x = header.bounds_min_z = maze.origin;
+    header.bounds_max_x = header.bounds_max_z = maze.origin + cells * MAZE_CELL_SIZE;
+    header.wall_count = wall_count;
+    header.pellet_count = pellet_count;
+    header.cherry_count = cherry_count;
+    header.ghost_count = ghost_count;
+    memcpy(blob, &header, sizeof(header));
+    ViewLevelBlob(blob, size, level);
+
+    // Escala e translação que levam a AABB da malha até a caixa da parede
+    LevelWall *walls = (LevelWall *)level.walls;
+    uint32_t wall = 0;
+    ForEachMazeWall(maze, [&](float min_x, float min_z, float max_x, float max_z)
+                    {
+        LevelWall &out = walls[wall++];
+        memset(&out, 0, sizeof(out));
+        out.scale[0] = (max_x - min_x) / (mesh.bbox_max.x - mesh.bbox_min.x);
+        out.scale[1] = 0.5f;
+        out.scale[2] = (max_z - min_z) / (mesh.bbox_max.z - mesh.bbox_min.z);
+        out.translate[0] = min_x - out.scale[0] * mesh.bbox_min.x;
+        out.translate[1] = -1.0f;
+        out.translate[2] = min_z - out.scale[2] * mesh.bbox_min.z;
+        out.object_type = 2; // LABYRINTH_2
+        strncpy(out.mesh, MAZE_WALL_MESH, sizeof(out.mesh) - 1); });
+
+    LevelPellet *pellets = (LevelPellet *)level.pellets;
+    for (int row = 0; row < cells; ++row)
+    {
+        for (int column = 0; column < cells; ++column)
+        {
+            glm::vec3 center = MazeCellCenter(maze, column, row, -0.8f);
+            pellets[(size_t)row * cells + column] = {center.x, center.y, center.z, 0.1f};
+        }
+    }
+
+    LevelCherry *cherries = (LevelCherry *)level.cherries;
+    const int corners[4][2] = {{0, 0}, {cells - 1, cells - 1}, {cells - 1, 0}, {0, cells - 1}};
+    for (int i = 0; i < 4; ++i)
+    {
+        glm::vec3 center = MazeCellCenter(maze, corners[i][0], corners[i][1], -0.7f);
+        cherries[i] = {center.x, center.y, center.z, 0.5f};
+    }
+
+    // Fantasmas em células sorteadas, fora de um quadrado em volta de (0, -1)
+    LevelGhost *ghosts = (LevelGhost *)level.ghosts;
+    uint32_t state = seed ^ 0x9e3779b9u;
+    for (uint32_t i = 0; i < ghost_count; ++i)
+    {
+        glm::vec3 center;
+        do
+        {
+            int column = (int)(NextMazeRandom(state) % (uint32_t)cells);
+            int row = (int)(NextMazeRandom(state) % (uint32_t)cells);
+            center = MazeCellCenter(maze, column, row, -1.4f);
+        } while (std::abs(center.x) <= MAZE_GHOST_SAFE_CELLS && std::abs(center.z + 1.0f) <= MAZE_GHOST_SAFE_CELLS);
+        ghosts[i] = {(int32_t)(i % 2), center.x, center.y, center.z};
+    }
+    return true;
+}
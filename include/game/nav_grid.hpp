@@ -0,0 +1,126 @@
+#pragma once
+
+// Grade de navegação dos fantasmas e campo de fluxo até o Pac-Man.
+//
+// O plano x/z da arena é dividido em células de NAV_CELL_SIZE; uma célula é
+// bloqueada se alguma parede (as mesmas AABBs de instanciateWalls()) cobre
+// parte dela. A cada passo, uma busca em largura a partir da célula do
+// Pac-Man guarda, para cada célula livre, a vizinha que está um passo mais
+// perto dele. A busca é feita uma única vez e compartilhada por todos os
+// fantasmas: cada um decide o próximo movimento com uma consulta O(1), então
+// o custo por fantasma não depende de quantos existem.
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <external/glm/vec3.hpp>
+
+#include "objects/objects.hpp"
+#include "collisions/spatial_grid.hpp"
+
+// Com células de 0.5 centradas em múltiplos de 0.5, os centros coincidem com
+// as linhas de bolinhas e cabem nos corredores mais estreitos do labirinto.
+const float NAV_CELL_SIZE = 0.5f;
+
+// As paredes precisam invadir a célula mais do que isso para bloqueá-la;
+// evita fechar um corredor por uma parede que apenas encosta na borda.
+const float NAV_WALL_TOLERANCE = 0.05f;
+
+struct NavGrid
+{
+    UniformGrid2D grid;
+    std::vector<uint8_t> walkable; // 1 se a célula é livre
+
+    // Campo de fluxo para "target_cell"
+    int target_cell = -1;
+    std::vector<int> distance;  // Passos até o alvo, -1 se inalcançável
+    std::vector<int> next_cell; // Vizinha um passo mais perto do alvo, -1 se nenhuma
+    std::vector<int> queue;     // Fila da busca, reaproveitada entre passos
+};
+
+NavGrid g_NavGrid;
+
+// Rasteriza "walls" sobre o retângulo "bounds" (somente x e z são usados).
+void BuildNavGrid(NavGrid &nav, const std::vector<AABB> &walls, const AABB &bounds)
+{
+    float half = NAV_CELL_SIZE / 2.0f;
+    nav.grid = MakeUniformGrid2D(bounds.min - half, bounds.max - half, NAV_CELL_SIZE);
+
+    const UniformGrid2D &grid = nav.grid;
+    int cell_total = grid.columns * grid.rows;
+    nav.walkable.assign(cell_total, 1);
+    for (const AABB &wall : walls)
+    {
+        int column_min = GridColumn(grid, wall.min.x + NAV_WALL_TOLERANCE);
+        int column_max = GridColumn(grid, wall.max.x - NAV_WALL_TOLERANCE);
+        int row_min = GridRow(grid, wall.min.z + NAV_WALL_TOLERANCE);
+        int row_max = GridRow(grid, wall.max.z - NAV_WALL_TOLERANCE);
+        for (int row = row_min; row <= row_max; ++row)
+            for (int column = column_min; column <= column_max; ++column)
+                nav.walkable[GridCellIndex(grid, column, row)] = 0;
+    }
+
+    nav.target_cell = -1;
+    nav.distance.assign(cell_total, -1);
+    nav.next_cell.assign(cell_total, -1);
+    nav.queue.resize(cell_total);
+}
+
+int NavCellAt(const NavGrid &nav, glm::vec3 position)
+{
+    return GridCellIndex(nav.grid, GridColumn(nav.grid, position.x), GridRow(nav.grid, position.z));
+}
+
+glm::vec3 NavCellCenter(const NavGrid &nav, int cell, float y)
+{
+    int column = cell % nav.grid.columns;
+    int row = cell / nav.grid.columns;
+    return glm::vec3(nav.grid.origin_x + (column + 0.5f) * nav.grid.cell_size, y,
+                     nav.grid.origin_z + (row + 0.5f) * nav.grid.cell_size);
+}
+
+// Busca em largura a partir de "target_cell" pelas células livres, em 4
+// direções. A célula alvo entra na busca mesmo que esteja bloqueada (o
+// Pac-Man pode encostar numa parede). Refeita só quando o alvo muda, já que
+// as paredes não mudam durante o jogo.
+void UpdateFlowField(NavGrid &nav, int target_cell)
+{
+    PROFILE_FUNCTION();
+    if (target_cell == nav.target_cell)
+        return;
+    nav.target_cell = target_cell;
+
+    std::fill(nav.distance.begin(), nav.distance.end(), -1);
+    std::fill(nav.next_cell.begin(), nav.next_cell.end(), -1);
+
+    const int columns = nav.grid.columns;
+    const int rows = nav.grid.rows;
+    int head = 0, tail = 0;
+    nav.queue[tail++] = target_cell;
+    nav.distance[target_cell] = 0;
+    nav.next_cell[target_cell] = target_cell;
+
+    while (head < tail)
+    {
+        int cell = nav.queue[head++];
+        int column = cell % columns;
+        int row = cell / columns;
+        int neighbors[4] = {column > 0 ? cell - 1 : -1, column < columns - 1 ? cell + 1 : -1,
+                            row > 0 ? cell - columns : -1, row < rows - 1 ? cell + columns : -1};
+        for (int neighbor : neighbors)
+        {
+            if (neighbor < 0 || !nav.walkable[neighbor] || nav.distance[neighbor] >= 0)
+                continue;
+            nav.distance[neighbor] = nav.distance[cell] + 1;
+            nav.next_cell[neighbor] = cell;
+            nav.queue[tail++] = neighbor;
+        }
+    }
+}
+
+// Próxima célula no caminho até o alvo, ou -1 se "cell" não o alcança.
+int NavNextCell(const NavGrid &nav, int cell)
+{
+    return nav.next_cell[cell];
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+// Simulação do jogo em passo fixo. O tempo real de cada quadro é acumulado e
+// consumido em passos de exatamente SIMULATION_DT segundos; a lógica do jogo
+// (animação de entrada, colisões, movimento do Pac-Man e dos fantasmas,
+// contagens regressivas) só avança dentro de SimulationTick(). Assim o
+// resultado depende apenas do número de passos e da entrada de cada passo,
+// não da taxa de quadros.
+//
+// Para que o movimento continue suave quando a taxa de quadros não é um
+// múltiplo de SIMULATION_HZ, a renderização desenha os personagens entre as
+// posições dos dois últimos passos, com o peso dado por FixedTimestepAlpha().
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include <external/glm/vec4.hpp>
+
+#include "globals/globals.hpp"
+#include "collisions/collisions.hpp"
+#include "objects/ball.hpp"
+#include "objects/cherry.hpp"
+#include "objects/ghost.hpp"
+#include "objects/pacman.hpp"
+#include "objects/wall.hpp"
+#include "game/nav_grid.hpp"
+#include "game/level.hpp"
+#include "utils/profiler.hpp"
+#include "utils/job_system.hpp"
+#include "utils/hash.hpp"
+
+const double SIMULATION_HZ = 120.0;
+const float SIMULATION_DT = (float)(1.0 / SIMULATION_HZ);
+
+// Um quadro mais longo que isso (janela arrastada, depurador) é truncado: o
+// jogo desacelera, mas nunca executa centenas de passos de uma vez.
+const double MAX_FRAME_TIME = 0.25;
+
+// As taxas abaixo reproduzem, por segundo, o que o jogo fazia por quadro a
+// 60 Hz: a animação de entrada avançava t em 0.008 e cada um dos dois
+// fantasmas descontava 0.01 do congelamento.
+const float BEZIER_INTRO_SPEED = 0.008f * 60.0f;  // Unidades de t por segundo
+const float GHOST_FREEZE_DECAY = 0.02f * 60.0f;   // Unidades por segundo
+
+// Limites da arena: a região da fase (LevelHeader::bounds) com esta margem
+// em x e z; no labirinto original, o mesmo volume do skybox (farplane / 4).
+const float ARENA_MARGIN = 1.0f;
+const float ARENA_HALF_HEIGHT = 20.0f;
+
+AABB g_ArenaBounds;
+
+// Estado do mundo simulado: uma tabela de arrays por tipo de entidade
+GhostTable ghosts;
+PelletPool pellets;
+CherryTable cherries;
+WallTable walls;
+int initial_ball_count;
+int eaten_ball_count;
+
+// Número de fantasmas criados a cada (re)início. Os primeiros são os da
+// fase; os demais (pacman_headless --ghosts N) servem para medir o custo da
+// perseguição com muitos fantasmas.
+int ghost_count = 2;
+
+// Cria os fantasmas da fase e, até completar "count", outros em células
+// livres sorteadas com semente fixa, para que toda execução com o mesmo
+// "ghost_count" seja igual.
+void SpawnGhosts(const LevelView &level, int count)
+{
+    ClearGhosts(ghosts);
+    for (uint32_t i = 0; i < level.header->ghost_count; ++i)
+    {
+        const LevelGhost &ghost = level.ghosts[i];
+        AddGhost(ghosts, ghost.type == SECOND ? SECOND : FIRST, glm::vec3(ghost.x, ghost.y, ghost.z));
+    }
+
+    std::vector<int> free_cells;
+    for (size_t cell = 0; cell < g_NavGrid.walkable.size(); ++cell)
+    {
+        if (g_NavGrid.walkable[cell])
+            free_cells.push_back((int)cell);
+    }
+
+    uint32_t state = 12345u;
+    for (int i = GhostCount(ghosts); i < count && !free_cells.empty(); ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        int cell = free_cells[(state >> 8) % free_cells.size()];
+        GhostType type = i % 2 == 0 ? FIRST : SECOND;
+        AddGhost(ghosts, type, NavCellCenter(g_NavGrid, cell, GHOST_SPAWN_Y));
+    }
+}
+
+// Recria o mundo no estado inicial a partir da fase g_Level (veja
+// LoadLevel()). As paredes usam as AABBs dos modelos do labirinto, que
+// precisam estar em g_VirtualScene (veja LoadLabyrinthObjects()).
+void InitializeWorld()
+{
+    const LevelView &level = g_Level;
+    const LevelHeader &header = *level.header;
+
+    inicialize_globals();
+    instanciateLittleBalls(pellets, level);
+    LoadPelletLayout(pellets);
+    instanciateCherries(cherries, level);
+    instanciateWalls(walls, level);
+    BuildNavGrid(g_NavGrid, g_WallGrid.boxes, AABB{glm::vec3(header.bounds_min_x, 0.0f, header.bounds_min_z), glm::vec3(header.bounds_max_x, 0.0f, header.bounds_max_z)});
+    SpawnGhosts(level, ghost_count);
+    g_ArenaBounds = {glm::vec3(header.bounds_min_x - ARENA_MARGIN, -ARENA_HALF_HEIGHT, header.bounds_min_z - ARENA_MARGIN),
+                     glm::vec3(header.bounds_max_x + ARENA_MARGIN, ARENA_HALF_HEIGHT, header.bounds_max_z + ARENA_MARGIN)};
+
+    initial_ball_count = LivePelletCount(pellets);
+    eaten_ball_count = 0;
+}
+
+struct FixedTimestep
+{
+    double last_time = 0.0;   // Instante do quadro anterior, em segundos
+    double accumulator = 0.0; // Tempo real ainda não simulado
+    long long tick = 0;       // Passos executados desde o (re)início do jogo
+};
+
+FixedTimestep g_FixedTimestep;
+
+void ResetFixedTimestep(double now)
+{
+    g_FixedTimestep.last_time = now;
+    g_FixedTimestep.accumulator = 0.0;
+    g_FixedTimestep.tick = 0;
+}
+
+// Acumula o tempo decorrido desde o quadro anterior e retorna quantos passos
+// de simulação devem ser executados neste quadro.
+int AdvanceFixedTimestep(double now)
+{
+    FixedTimestep &timestep = g_FixedTimestep;
+    double frame_time = std::min(now - timestep.last_time, MAX_FRAME_TIME);
+    timestep.last_time = now;
+    timestep.accumulator += std::max(frame_time, 0.0);
+
+    int ticks = (int)(timestep.accumulator / SIMULATION_DT);
+    timestep.accumulator -= ticks * (double)SIMULATION_DT;
+    return ticks;
+}
+
+// Fração de um passo já decorrida e ainda não simulada, em [0, 1).
+float FixedTimestepAlpha()
+{
+    return (float)(g_FixedTimestep.accumulator / SIMULATION_DT);
+}
+
+glm::vec4 InterpolatedPacmanPosition(float alpha)
+{
+    return pacman_previous_position + (pacman_position_c - pacman_previous_position) * alpha;
+}
+
+// Avança o jogo exatamente SIMULATION_DT segundos.
+void SimulationTick(const PacmanInput &input)
+{
+    PROFILE_FUNCTION();
+    const float dt = SIMULATION_DT;
+
+    pacman_previous_position = pacman_position_c;
+    UpdatePacmanCameraMode();
+
+    if (t <= 1)
+    {
+        t += BEZIER_INTRO_SPEED * dt;
+        curr_bezier_position = calculateBezierPosition(initial_position_bezier, intermediate_position_bezier_1, intermediate_position_bezier_2, final_position_bezier, std::min(t, 1.0f));
+        pacman_position_c = curr_bezier_position;
+    }
+
+    Sphere pacman_sphere = {pacman_position_c, pacman_size + 0.1f};
+    bool caught = false;
+
+    // O restante do passo é um grafo de jobs (veja job_system.hpp). As
+    // bolinhas só dependem da esfera acima e são testadas em paralelo com o
+    // resto; as cerejas decidem o impulso de velocidade e o congelamento, lidos
+    // pelo movimento do Pac-Man e dos fantasmas, e os fantasmas perseguem a
+    // posição já atualizada do Pac-Man.
+    JobGraph graph;
+    AddJob(graph, "PelletJob", [&]()
+           { checkLittleBallsCollision(pellets, pacman_sphere, eaten_ball_count); });
+    Job *cherry_job = AddJob(graph, "CherryJob", [&]()
+                             { checkCherriesCollision(cherries, pacman_sphere); });
+
+    Job *pacman_job = AddJob(graph, "PacmanJob", [&]()
+                             {
+        std::vector<glm::vec4> all_collision_directions;
+
+        if (shouldBoostSpeed)
+        {
+            BoostPacmanSpeed(dt);
+        }
+
+        // Testes de colisão com as paredes limítrofes: colisão esfera-plano
+        {
+            PROFILE_SCOPE("checkSphereToPlaneCollision");
+            glm::vec4 collision_direction_sky = checkSphereToPlaneCollision(g_ArenaBounds, pacman_sphere);
+            all_collision_directions.push_back(collision_direction_sky);
+        }
+
+        // As paredes do labirinto são tratadas dentro de MovePacman(), com teste contínuo
+        MovePacman(input, dt, all_collision_directions); });
+    AddJobDependency(pacman_job, cherry_job);
+
+    Job *ghost_job = AddJob(graph, "GhostJob", [&]()
+                            {
+        freeze_ghosts_countdown = std::max(0.0f, freeze_ghosts_countdown - GHOST_FREEZE_DECAY * dt);
+
+        // Uma busca compartilhada por todos os fantasmas; cada um só consulta a
+        // própria célula.
+        UpdateFlowField(g_NavGrid, NavCellAt(g_NavGrid, glm::vec3(pacman_position_c)));
+        MoveGhosts(ghosts, dt, g_NavGrid);
+        caught = GhostsCaughtPacman(ghosts, pacman_sphere); });
+    AddJobDependency(ghost_job, pacman_job);
+
+    RunJobGraph(graph);
+
+    won_game = LivePelletCount(pellets) == 0;
+    game_over = caught || won_game;
+
+    g_FixedTimestep.tick += 1;
+}
+
+// Resumo (FNV-1a de 64 bits) do estado que a simulação altera: posições,
+// velocidade, contagens regressivas, bolinhas e cerejas restantes. Dois
+// jogos com a mesma entrada no mesmo executável terminam com o mesmo valor;
+// usado para verificar a reprodução de entradas gravadas (input_record.hpp).
+uint64_t SimulationChecksum()
+{
+    const float state[] = {pacman_position_c.x, pacman_position_c.y, pacman_position_c.z, pacman_rotation,
+                           PACMAN_SPEED, pacman_boost_elapsed, t, freeze_ghosts_countdown};
+    uint64_t hash = HashBytes(state, sizeof(state));
+    hash = HashBytes(ghosts.x.data(), ghosts.x.size() * sizeof(float), hash);
+    hash = HashBytes(ghosts.z.data(), ghosts.z.size() * sizeof(float), hash);
+
+    const int counts[] = {LivePelletCount(pellets), eaten_ball_count, CherryCount(cherries), (int)game_over, (int)won_game};
+    hash = HashBytes(counts, sizeof(counts), hash);
+    if (!pellets.alive_mask.empty())
+        hash = HashBytes(pellets.alive_mask.data(), pellets.alive_mask.size() * sizeof(uint32_t), hash);
+    hash = HashBytes(cherries.x.data(), cherries.x.size() * sizeof(float), hash);
+    hash = HashBytes(cherries.z.data(), cherries.z.size() * sizeof(float), hash);
+    return hash;
+}
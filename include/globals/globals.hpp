@@ -16,9 +16,19 @@
 #include <stdexcept>
 #include <algorithm>
 
-// Headers das bibliotecas OpenGL
+// Headers das bibliotecas OpenGL. No alvo pacman_headless (PACMAN_HEADLESS)
+// não há janela nem contexto OpenGL: somente os tipos escalares usados pelos
+// globais são declarados, e todo código que chama a API fica de fora.
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#else
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+#define GL_TRIANGLES 0x0004
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
@@ -51,10 +61,17 @@ GLint g_projection_uniform;
 GLint g_object_id_uniform;
 GLint g_bbox_min_uniform;
 GLint g_bbox_max_uniform;
+GLint g_is_free_cam_on_uniform;
+GLint g_game_over_uniform;
+GLint g_won_game_uniform;
 
 // Razão de proporção da janela (largura/altura). Veja função FramebufferSizeCallback().
 float g_ScreenRatio = 1.0f;
 
+// Chamadas de desenho e triângulos do quadro atual. Veja stats_overlay.hpp.
+int g_FrameDrawCalls = 0;
+long long g_FrameTriangles = 0;
+
 // "g_LeftMouseButtonPressed = true" se o usuário está com o botão esquerdo do mouse
 // pressionado no momento atual. Veja função MouseButtonCallback().
 bool g_LeftMouseButtonPressed;
@@ -72,9 +89,6 @@ float g_CameraDistance; // Distância da câmera para a origem
 const float MAX_BOUNDARY = 9.0f;
 const float MIN_BOUNDARY = -9.0f;
 
-float previousTime = (float)glfwGetTime();
-float pacmanPreviousTime = (float)glfwGetTime();
-
 bool isFreeCamOn;
 
 // Variável que controla o tipo de projeção utilizada: perspectiva ou ortográfica.
@@ -92,8 +106,11 @@ float pacman_size;
 
 const float PACMAN_ORIGINAL_SPEED = 2.5f;
 const float PACMAN_BOOST = 4.0f;
+const float PACMAN_BOOST_DURATION = 1.5f; // Segundos
 float PACMAN_SPEED;
 bool shouldBoostSpeed;
+bool pacman_boost_active;
+float pacman_boost_elapsed;
 
 bool movePacmanForward;
 bool movePacmanBackward;
@@ -114,18 +131,17 @@ glm::vec4 curr_bezier_position;
 glm::vec4 pacman_position_initial;
 glm::vec4 pacman_movement;
 glm::vec4 pacman_position_c;
+glm::vec4 pacman_previous_position; // Posição no passo de simulação anterior
 
 // Variáveis para controle de movimento do fantasma
 float ghost_lookat_size;
 float ghost_size = ghost_lookat_size;
 
-const float GHOST_SPEED = 8.0f;
 float freeze_ghosts_countdown;
 
 bool should_restart;
 bool game_over;
 bool won_game;
-bool should_reload;
 
 void inicialize_globals()
 {
@@ -137,9 +153,6 @@ void inicialize_globals()
     g_CameraPhi = 0.0f;
     g_CameraDistance = 15.0f;
 
-    previousTime = (float)glfwGetTime();
-    pacmanPreviousTime = (float)glfwGetTime();
-
     isFreeCamOn = false;
 
     g_UsePerspectiveProjection = true;
@@ -152,6 +165,8 @@ void inicialize_globals()
 
     PACMAN_SPEED = PACMAN_ORIGINAL_SPEED;
     shouldBoostSpeed = false;
+    pacman_boost_active = false;
+    pacman_boost_elapsed = 0.0f;
 
     movePacmanForward = false;
     movePacmanBackward = false;
@@ -171,7 +186,9 @@ void inicialize_globals()
     curr_bezier_position = initial_position_bezier;
     pacman_position_initial = final_position_bezier;
     pacman_movement = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    pacman_position_c = pacman_position_initial;
+    // O jogo sempre começa pela animação de entrada (t = 0)
+    pacman_position_c = curr_bezier_position;
+    pacman_previous_position = pacman_position_c;
 
     ghost_lookat_size = 0.4f;
     ghost_size = ghost_lookat_size;
@@ -181,5 +198,4 @@ void inicialize_globals()
     should_restart = false;
     game_over = false;
     won_game = false;
-    should_reload = true;
 }
@@ -1,139 +1,209 @@
+#pragma once
+
 // Headers das bibliotecas OpenGL
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
 #include <external/glm/vec4.hpp>
 #include <external/glm/gtc/type_ptr.hpp>
 
+#ifndef PACMAN_HEADLESS
+#include "utils/shader_utils.hpp"
+#endif
 #include "objects/objects.hpp"
 #include "globals/globals.hpp"
 #include "collisions/collisions.hpp"
+#include "collisions/spatial_grid.hpp"
+#include "objects/pellet_pool.hpp"
+#include "game/level.hpp"
 #include "matrices.h"
+#include "utils/profiler.hpp"
+
+// As bolinhas não são desenhadas com a malha "the_sphere": cada uma vira um
+// quadrado voltado para a câmera e a esfera é calculada por ray casting no
+// Fragment Shader ("pellet_vertex.glsl" e "pellet_fragment.glsl"). São 4
+// vértices por bolinha, ao invés dos 672 da malha.
+//
+// As bolinhas só são removidas durante o jogo. Por isso o layout inicial
+// (centro e raio de todas) é enviado uma única vez para a GPU, junto com uma
+// máscara de bits em um "buffer texture" indicando quais ainda existem. Comer
+// uma bolinha altera um único bit; o desenho é sempre a mesma chamada
+// instanciada, sem percorrer as bolinhas. A máscara é a mesma do PelletPool
+// (veja pellet_pool.hpp), usada também pelos testes de colisão.
+#ifndef PACMAN_HEADLESS
+GLuint g_PelletProgramID = 0;
+GLint g_pellet_view_uniform;
+GLint g_pellet_projection_uniform;
+
+GLuint g_PelletVertexArrayID = 0;
+GLuint g_PelletInstanceBufferID = 0;
+GLuint g_PelletAliveBufferID = 0;
+GLuint g_PelletAliveTextureID = 0;
+GLuint g_PelletAliveTextureUnit = 0;
+#endif
+GLsizei g_PelletCount = 0;
+
+// Grade usada pelos testes de colisão (veja spatial_grid.hpp)
+PelletGrid g_PelletGrid;
+
+// Palavras da máscara alteradas desde o último envio para a GPU, no
+// intervalo [begin, end). A colisão roda em um job (veja job_system.hpp) e
+// não pode chamar OpenGL; o envio fica para RenderPellets(), na thread
+// principal.
+int g_PelletMaskDirtyBegin = 0;
+int g_PelletMaskDirtyEnd = 0;
+
+#ifndef PACMAN_HEADLESS
+void SetupPelletProgram(GLuint program_id)
+{
+    g_pellet_view_uniform = glGetUniformLocation(program_id, "view");
+    g_pellet_projection_uniform = glGetUniformLocation(program_id, "projection");
+
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "LittleBallTexture"), 4);
+    glUniform1i(glGetUniformLocation(program_id, "PelletAliveMask"), g_PelletAliveTextureUnit);
+    glUseProgram(0);
+}
 
-class Ball
+// Carrega o programa de GPU dos impostores e cria o VAO com os cantos do
+// quadrado (location = 0) e um buffer por instância com centro e raio de
+// cada bolinha (location = 3). Deve ser chamada após LoadTexturesFromFiles(),
+// pois ocupa a próxima unidade de textura livre com a máscara de bits.
+void LoadPelletImpostors()
 {
-public:
-    // Atributos:
-    glm::mat4 modelMatrix;
-    int objectType;
-    std::string objectName;
-    Sphere b_sphere;
-
-    // Construtor
-    Ball(glm::vec3 center, float radius, int objectType, std::string objectName)
-        : modelMatrix(modelMatrix), objectType(objectType), objectName(objectName)
-    {
-        this->modelMatrix = Matrix_Translate(center.x, center.y, center.z) * Matrix_Scale(radius, radius, radius);
-        this->b_sphere = Sphere{center, radius};
-    }
-    // Métodos:
-    void render()
-    {
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-        glUniform1i(g_object_id_uniform, objectType);
-        DrawVirtualObject(objectName.c_str());
-    }
-};
+    g_PelletAliveTextureUnit = g_NumLoadedTextures++;
+
+    glGenBuffers(1, &g_PelletAliveBufferID);
+    glGenTextures(1, &g_PelletAliveTextureID);
+    glActiveTexture(GL_TEXTURE0 + g_PelletAliveTextureUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, g_PelletAliveTextureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, g_PelletAliveBufferID);
+
+    g_PelletProgramID = LoadGpuProgram("../../resources/shaders/pellet_vertex.glsl",
+                                       "../../resources/shaders/pellet_fragment.glsl");
+    SetupPelletProgram(g_PelletProgramID);
+
+    glGenVertexArrays(1, &g_PelletVertexArrayID);
+    glBindVertexArray(g_PelletVertexArrayID);
+
+    const float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    GLuint corners_id;
+    glGenBuffers(1, &corners_id);
+    glBindBuffer(GL_ARRAY_BUFFER, corners_id);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &g_PelletInstanceBufferID);
+    glBindBuffer(GL_ARRAY_BUFFER, g_PelletInstanceBufferID);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glVertexAttribDivisor(3, 1); // Um valor por instância
+    glEnableVertexAttribArray(3);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(0);
+}
+#endif
 
-std::vector<Ball> instanciateLittleBalls()
+// Envia para a GPU o layout inicial das bolinhas e a máscara de bits do pool,
+// e monta a grade de colisão. Chamada uma vez a cada (re)início do jogo.
+void LoadPelletLayout(const PelletPool &pellets)
 {
-    std::vector<Ball> balls;
+    std::vector<glm::vec4> instances;
+    instances.reserve(PelletCapacity(pellets));
+    for (int h = 0; h < PelletCapacity(pellets); ++h)
+        instances.push_back(glm::vec4(PelletCenter(pellets, h), pellets.radius[h]));
+    g_PelletCount = (GLsizei)instances.size();
+    BuildPelletGrid(g_PelletGrid, pellets);
+
+#ifndef PACMAN_HEADLESS
+    glBindBuffer(GL_ARRAY_BUFFER, g_PelletInstanceBufferID);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::vec4), instances.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Um bit por bolinha; os bits além de g_PelletCount nunca são lidos.
+    const std::vector<uint32_t> &mask = pellets.alive_mask;
+    glBindBuffer(GL_TEXTURE_BUFFER, g_PelletAliveBufferID);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(mask.size(), 1) * sizeof(GLuint), mask.empty() ? NULL : mask.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+#endif
+    g_PelletMaskDirtyBegin = g_PelletMaskDirtyEnd = 0;
+}
 
-    // Quadrado de fora:
-    float z = 8.0f;
-    for (int i = 0; i < 33; i++)
+// Remove a bolinha "handle" do pool e marca a palavra de 32 bits da máscara
+// que a contém para ser enviada à GPU no próximo desenho.
+void KillPellet(PelletPool &pellets, int handle)
+{
+    int word = RemovePellet(pellets, handle);
+    if (g_PelletMaskDirtyBegin == g_PelletMaskDirtyEnd)
     {
-        Ball right = {glm::vec3(8.5f, -0.8f, z), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(right);
-
-        Ball left = {glm::vec3(-8.5, -0.8f, z), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(left);
-
-        z -= 0.5f;
+        g_PelletMaskDirtyBegin = word;
+        g_PelletMaskDirtyEnd = word + 1;
     }
-    float x = 8.0f;
-    for (int i = 0; i < 33; i++)
+    else
     {
-        Ball up = {glm::vec3(x, -0.8f, 8.5), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(up);
-
-        Ball down = {glm::vec3(x, -0.8f, -8.5), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(down);
-
-        x -= 0.5f;
+        g_PelletMaskDirtyBegin = std::min(g_PelletMaskDirtyBegin, word);
+        g_PelletMaskDirtyEnd = std::max(g_PelletMaskDirtyEnd, word + 1);
     }
+}
 
-    // Adiciona as bolinhas dos cantos manualmente para não sobrescrever:
-    Ball outerCornerBall = {glm::vec3(8.5, -0.8f, 8.5), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(outerCornerBall);
-    outerCornerBall = {glm::vec3(-8.5, -0.8f, 8.5), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(outerCornerBall);
-    outerCornerBall = {glm::vec3(8.5f, -0.8f, -8.5), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(outerCornerBall);
-    outerCornerBall = {glm::vec3(-8.5, -0.8f, -8.5), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(outerCornerBall);
-
-    // Quadrado de dentro:
-    z = -1.5f;
-    for (int i = 0; i < 7; i++)
+#ifndef PACMAN_HEADLESS
+// Desenha todas as bolinhas com uma única chamada instanciada; as que já
+// foram comidas são descartadas no Vertex Shader. Custo constante na CPU:
+// da máscara, só as palavras alteradas desde o último quadro são enviadas.
+void RenderPellets(const PelletPool &pellets, const glm::mat4 &view, const glm::mat4 &projection)
+{
+    if (g_PelletMaskDirtyBegin < g_PelletMaskDirtyEnd)
     {
-        Ball inner_left = {glm::vec3(3.2f, -0.8f, z), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(inner_left);
+        int words = g_PelletMaskDirtyEnd - g_PelletMaskDirtyBegin;
+        glBindBuffer(GL_TEXTURE_BUFFER, g_PelletAliveBufferID);
+        glBufferSubData(GL_TEXTURE_BUFFER, g_PelletMaskDirtyBegin * sizeof(GLuint), words * sizeof(GLuint), &pellets.alive_mask[g_PelletMaskDirtyBegin]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        g_PelletMaskDirtyBegin = g_PelletMaskDirtyEnd = 0;
+    }
 
-        Ball inner_right = {glm::vec3(-3.35f, -0.8f, z), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(inner_right);
+    if (g_PelletCount == 0)
+        return;
 
-        z += 0.5f;
-    }
-    x = -2.85f;
-    for (int i = 0; i < 12; i++)
-    {
-        Ball inner_up = {glm::vec3(x, -0.8f, -2.0f), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(inner_up);
+    glUseProgram(g_PelletProgramID);
+    glUniformMatrix4fv(g_pellet_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_pellet_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
 
-        Ball inner_down = {glm::vec3(x, -0.8f, 2.0f), 0.1f, SPHERE, "the_sphere"};
-        balls.push_back(inner_down);
+    glBindVertexArray(g_PelletVertexArrayID);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, g_PelletCount);
+    glBindVertexArray(0);
 
-        x += 0.5f;
-    }
-    // Adiciona as bolinhas dos cantos manualmente para não sobrescrever:
-    Ball innerCornerBall = {glm::vec3(-3.35, -0.8f, -2.0f), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(innerCornerBall);
-    innerCornerBall = {glm::vec3(-3.35, -0.8f, 2.0f), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(innerCornerBall);
-    innerCornerBall = {glm::vec3(3.2, -0.8f, -2.0f), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(innerCornerBall);
-    innerCornerBall = {glm::vec3(3.2, -0.8f, 2.0f), 0.1f, SPHERE, "the_sphere"};
-    balls.push_back(innerCornerBall);
-
-    return balls;
-};
-
-void checkLittleBallsCollision(std::vector<Ball> &balls, Sphere pacman_sphere, int &eaten_ball_count)
-{
-    std::vector<int> remove_indexes = {};
+    g_FrameDrawCalls += 1;
+    g_FrameTriangles += 2 * g_PelletCount;
+}
+#endif
 
-    int index = 0;
-    for (Ball &ball : balls)
+void instanciateLittleBalls(PelletPool &pellets, const LevelView &level)
+{
+    ClearPelletPool(pellets);
+    for (uint32_t i = 0; i < level.header->pellet_count; ++i)
     {
-        bool ate = checkSphereToSphereCollision(pacman_sphere, ball.b_sphere);
-        if (ate)
-        {
-            remove_indexes.push_back(index);
-        }
-        else
-        {
-            ball.render();
-        }
-
-        index++;
+        const LevelPellet &pellet = level.pellets[i];
+        AddPellet(pellets, glm::vec3(pellet.x, pellet.y, pellet.z), pellet.radius);
     }
+}
+
+// Só as células da grade próximas ao Pac-Man são testadas, então o custo por
+// quadro não cresce com o número de bolinhas.
+void checkLittleBallsCollision(PelletPool &pellets, Sphere pacman_sphere, int &eaten_ball_count)
+{
+    PROFILE_FUNCTION();
+    std::vector<int> &eaten = pellets.eaten;
+    eaten.clear();
+    FindPelletsTouching(g_PelletGrid, pellets, pacman_sphere, eaten);
 
-    for (int idx : remove_indexes)
+    for (int handle : eaten)
     {
-        balls.erase(balls.begin() + idx);
+        KillPellet(pellets, handle);
         eaten_ball_count += 1;
     }
 }
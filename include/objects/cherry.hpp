@@ -1,100 +1,120 @@
+#pragma once
+
 // Headers das bibliotecas OpenGL
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
 #include <external/glm/vec4.hpp>
 #include <external/glm/gtc/type_ptr.hpp>
 
+#ifndef PACMAN_HEADLESS
 #include "utils/shader_utils.hpp"
+#endif
 #include "objects/objects.hpp"
+#include "objects/render_packets.hpp"
+#include "game/level.hpp"
 #include "globals/globals.hpp"
 #include "collisions/collisions.hpp"
+#include "collisions/simd_collisions.hpp"
 #include "matrices.h"
+#include "utils/profiler.hpp"
 
-class Cherry
+// Tabela das cerejas: esfera de colisão em arrays separados, no formato
+// lido por SphereOverlapSpheres(), e o componente de desenho.
+struct CherryTable
 {
-public:
-    // Atributos:
-    glm::mat4 modelMatrix;
-    int objectId;
-    int objectType;
-    std::string objectName;
-    glm::vec3 center;
-    Sphere cherry_sphere;
+    std::vector<float> x, y, z, radius;
+    std::vector<uint32_t> hit_mask; // HitMaskWords(contagem) palavras, reaproveitadas a cada passo
+    RenderComponents render;
+};
 
-    // Métodos:
+int CherryCount(const CherryTable &cherries)
+{
+    return (int)cherries.radius.size();
+}
 
-    // Construtor
-    Cherry(glm::mat4 modelMatrix, int objectId, int objectType, std::string objectName, glm::vec3 center, float radius)
-        : modelMatrix(modelMatrix), objectId(objectId), objectType(objectType), objectName(objectName)
-    {
-        this->center = center;
-        this->cherry_sphere = Sphere{center, radius};
-    }
+void AddCherry(CherryTable &cherries, glm::vec3 center, float radius)
+{
+    cherries.x.push_back(center.x);
+    cherries.y.push_back(center.y);
+    cherries.z.push_back(center.z);
+    cherries.radius.push_back(radius);
+    cherries.hit_mask.resize(HitMaskWords(CherryCount(cherries)));
+    AddRenderComponent(cherries.render, CHERRY, "Cherry");
+}
 
-    void render()
-    {
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-        glUniform1i(g_object_id_uniform, objectType);
-        DrawVirtualObject(objectName.c_str());
-    }
-};
+// O(1): a última cereja ocupa o lugar da removida.
+void RemoveCherry(CherryTable &cherries, int index)
+{
+    cherries.x[index] = cherries.x.back();
+    cherries.y[index] = cherries.y.back();
+    cherries.z[index] = cherries.z.back();
+    cherries.radius[index] = cherries.radius.back();
+    cherries.x.pop_back();
+    cherries.y.pop_back();
+    cherries.z.pop_back();
+    cherries.radius.pop_back();
+    cherries.hit_mask.resize(HitMaskWords(CherryCount(cherries)));
+    RemoveRenderComponent(cherries.render, index);
+}
 
-std::vector<Cherry> instanciateCherries()
+void instanciateCherries(CherryTable &cherries, const LevelView &level)
 {
-    std::vector<Cherry> cherries;
-    int objectIdCounter = 0;
+    cherries.x.clear();
+    cherries.y.clear();
+    cherries.z.clear();
+    cherries.radius.clear();
+    cherries.hit_mask.clear();
+    ClearRenderComponents(cherries.render);
 
-    float x = -4.5f;
-    float z = -7.0f;
-    for (int i = 0; i < 4; i++)
+    for (uint32_t i = 0; i < level.header->cherry_count; ++i)
     {
-        Cherry cherry = {Matrix_Translate(x, -0.5f, z) * Matrix_Rotate_X(3.14159f / 2) * Matrix_Rotate_Z(3.14159f) * Matrix_Scale(0.002f, 0.002f, 0.002f), objectIdCounter++, CHERRY, "Cherry", glm::vec3(x, -0.7f, z), 0.5f};
-        cherries.push_back(cherry);
-
-        if (i % 2 == 0)
-            x = -x;
-
-        z = -z;
+        const LevelCherry &cherry = level.cherries[i];
+        AddCherry(cherries, glm::vec3(cherry.x, cherry.y, cherry.z), cherry.radius);
     }
-
-    return cherries;
 }
 
-void checkCherriesCollision(std::vector<Cherry> &cherries, Sphere pacman_sphere)
+void checkCherriesCollision(CherryTable &cherries, Sphere pacman_sphere)
 {
-    std::vector<int> remove_cherry_indexes = {};
+    PROFILE_FUNCTION();
+    int count = CherryCount(cherries);
+    if (count == 0)
+        return;
+
+    SphereSoA spheres = {cherries.x.data(), cherries.y.data(), cherries.z.data(), cherries.radius.data(), count};
+    uint32_t *mask = cherries.hit_mask.data();
+    SphereOverlapSpheres(pacman_sphere, spheres, mask);
 
-    int cherry_index = 0;
-    for (Cherry &cherry : cherries)
+    // De trás para frente: a remoção só move cerejas já testadas e, ao
+    // encolher a máscara, mantém as palavras das que faltam
+    for (int i = count - 1; i >= 0; --i)
     {
-        bool ate = checkSphereToSphereCollision(pacman_sphere, cherry.cherry_sphere);
-        if (ate)
+        if (HitMaskTest(mask, i))
         {
-            remove_cherry_indexes.push_back(cherry_index);
+            RemoveCherry(cherries, i);
             shouldBoostSpeed = true;
             freeze_ghosts_countdown = 10.0f;
-            // ReloadShaders();
-        }
-        else
-        {
-            if (isFreeCamOn)
-            {
-                cherry.modelMatrix = Matrix_Translate(cherry.center.x, cherry.center.y, cherry.center.z) * Matrix_Rotate_X(3.14159f) * Matrix_Rotate_Z(3.14159f) * Matrix_Scale(0.001f, 0.001f, 0.001f);
-            }
-            else
-            {
-                cherry.modelMatrix = Matrix_Translate(cherry.center.x, cherry.center.y, cherry.center.z) * Matrix_Rotate_X(3.14159f / 2) * Matrix_Rotate_Z(3.14159f) * Matrix_Scale(0.002f, 0.002f, 0.002f);
-            }
-            cherry.render();
         }
-        cherry_index++;
     }
+}
 
-    for (int idx : remove_cherry_indexes)
+void BuildCherryPackets(const CherryTable &cherries, const Frustum &frustum, RenderPacketList &list, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
     {
-        cherries.erase(cherries.begin() + idx);
+        float scale = isFreeCamOn ? 0.001f : 0.002f;
+        glm::mat4 model = Matrix_Translate(cherries.x[i], cherries.y[i], cherries.z[i]);
+        if (isFreeCamOn)
+            model = model * Matrix_Rotate_X(3.14159f) * Matrix_Rotate_Z(3.14159f) * Matrix_Scale(scale, scale, scale);
+        else
+            model = model * Matrix_Rotate_X(3.14159f / 2) * Matrix_Rotate_Z(3.14159f) * Matrix_Scale(scale, scale, scale);
+
+        MeshHandle mesh = cherries.render.mesh[i];
+        list.packets[i] = {model, cherries.render.object_type[i], mesh};
+        list.visible[i] = FrustumContainsSphere(frustum, glm::vec3(cherries.x[i], cherries.y[i], cherries.z[i]), MeshBoundingRadius(mesh) * scale);
     }
 }
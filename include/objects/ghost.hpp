@@ -1,8 +1,10 @@
 #pragma once
 
 // Headers das bibliotecas OpenGL
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
@@ -10,17 +12,13 @@
 #include <external/glm/gtc/type_ptr.hpp>
 
 #include "objects/objects.hpp"
+#include "objects/render_packets.hpp"
 #include "globals/globals.hpp"
 #include "matrices.h"
-
-enum class Direction
-{
-    FORWARD = 0,
-    BACKWARD = 1,
-    RIGHT = 2,
-    LEFT = 3,
-    NONE = 4
-};
+#include "utils/profiler.hpp"
+#include "utils/job_system.hpp"
+#include "collisions/simd_collisions.hpp"
+#include "game/nav_grid.hpp"
 
 enum GhostType
 {
@@ -28,124 +26,177 @@ enum GhostType
     SECOND = 1
 };
 
-class Ghost
+// Os fantasmas perseguem o Pac-Man pelo campo de fluxo de nav_grid.hpp, um
+// pouco mais devagar que ele (PACMAN_ORIGINAL_SPEED), para que ainda seja
+// possível fugir.
+const float GHOST_CHASE_SPEED = 2.0f;
+
+// Tabela dos fantasmas. O movimento lê e escreve somente posição, rotação e
+// célula alvo; a colisão lê somente posição e raio, no formato de
+// SphereOverlapSpheres(); o desenho lê o resto.
+struct GhostTable
 {
-public:
-    // Atributos:
-    float radius;
-    glm::mat4 modelMatrix;
-    int objectType;
-    std::string objectName;
-    Direction direction;
-    glm::vec4 current_position;
-    glm::vec4 initial_position;
-    glm::vec4 final_position;
-    float rotation;
-    float radius_bbox;
-
-    // Métodos:
-
-    // Construtor
-    Ghost(int objectType, std::string objectName, glm::vec4 initial_position, glm::vec4 final_position, float radius)
-        : objectType(objectType), objectName(objectName), initial_position(initial_position), final_position(final_position), radius(radius)
-    {
-        this->direction = Direction::NONE;
-        this->current_position = initial_position;
-        this->rotation = -INITIAL_ROTATION;
-        this->radius_bbox = radius;
-    }
+    // Transformação
+    std::vector<float> x, y, z;                // Posição atual
+    std::vector<float> previous_x, previous_z; // Posição no passo anterior (y não muda)
+    std::vector<float> rotation;
+
+    // Colisão
+    std::vector<float> hit_radius;
+    std::vector<uint32_t> hit_mask; // HitMaskWords(contagem) palavras, reaproveitadas a cada passo
+
+    // Perseguição: célula da grade de navegação para onde o fantasma está
+    // indo, ou -1 antes do primeiro movimento
+    std::vector<int> target_cell;
+
+    // Desenho
+    std::vector<float> scale;
+    RenderComponents render;
+};
 
-    // inicializador vazio apenas para o início
-    Ghost() {}
+int GhostCount(const GhostTable &ghosts)
+{
+    return (int)ghosts.x.size();
+}
 
-    void render()
-    {
-        modelMatrix = Matrix_Translate(current_position.x, current_position.y, current_position.z) * Matrix_Rotate_Y(rotation) * Matrix_Scale(radius, radius, radius);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-        glUniform1i(g_object_id_uniform, objectType);
-        DrawVirtualObject(objectName.c_str());
-    }
+void ClearGhosts(GhostTable &ghosts)
+{
+    ghosts.x.clear();
+    ghosts.y.clear();
+    ghosts.z.clear();
+    ghosts.previous_x.clear();
+    ghosts.previous_z.clear();
+    ghosts.rotation.clear();
+    ghosts.hit_radius.clear();
+    ghosts.target_cell.clear();
+    ghosts.scale.clear();
+    ghosts.hit_mask.clear();
+    ClearRenderComponents(ghosts.render);
+}
 
-    void move(float elapsedTime)
-    {
-        freeze_ghosts_countdown = std::max(0.0f, freeze_ghosts_countdown - 0.01f);
-        if (game_over)
-            return;
+// Altura dos fantasmas criados fora das posições da fase
+const float GHOST_SPAWN_Y = -1.4f;
 
-        if (current_position.x == initial_position.x && current_position.z != initial_position.z)
-        {
-            direction = Direction::BACKWARD;
-        }
-        else if (current_position.x == final_position.x && current_position.z != final_position.z)
-        {
-            direction = Direction::FORWARD;
-        }
-        else if (current_position.x == initial_position.x && current_position.z == initial_position.z)
-        {
-            direction = Direction::LEFT;
-        }
-        else if (current_position.x == final_position.x && current_position.z == final_position.z)
-        {
-            direction = Direction::RIGHT;
-        }
+void AddGhost(GhostTable &ghosts, GhostType type, glm::vec3 position)
+{
+    ghosts.x.push_back(position.x);
+    ghosts.y.push_back(position.y);
+    ghosts.z.push_back(position.z);
+    ghosts.previous_x.push_back(position.x);
+    ghosts.previous_z.push_back(position.z);
+    ghosts.rotation.push_back(-INITIAL_ROTATION);
+    ghosts.hit_radius.push_back(ghost_size);
+    ghosts.target_cell.push_back(-1);
+    ghosts.scale.push_back(ghost_size);
+    ghosts.hit_mask.resize(HitMaskWords(GhostCount(ghosts)));
+    AddRenderComponent(ghosts.render, type == SECOND ? GHOST2 : GHOST, "ghost");
+}
 
-        if (freeze_ghosts_countdown > 0.0f)
-        {
-            return;
-        }
+// Fantasmas por job em MoveGhosts(): o bastante para que o custo de criar e
+// distribuir o job seja pequeno perto do movimento.
+const int GHOST_JOB_GRAIN = 256;
 
-        switch (direction)
-        {
-        case Direction::FORWARD:
-            current_position.z = std::max(current_position.z - GHOST_SPEED * elapsedTime, final_position.z);
-            rotation = 3.14159f;
-            break;
-        case Direction::BACKWARD:
-            current_position.z = std::min(current_position.z + GHOST_SPEED * elapsedTime, initial_position.z);
-            rotation = 0.0f;
-            break;
-        case Direction::RIGHT:
-            current_position.x = std::min(current_position.x + GHOST_SPEED * elapsedTime, initial_position.x);
-            rotation = 3.14159f / 2;
-            break;
-        case Direction::LEFT:
-            current_position.x = std::max(current_position.x - GHOST_SPEED * elapsedTime, final_position.x);
-            rotation = -3.14159f / 2;
-            break;
-        case Direction::NONE:
-            break;
-        }
-    }
-
-    bool collided(Sphere pacman)
+// Cada fantasma anda de centro em centro de célula. Ao chegar ao centro da
+// célula alvo, a próxima vem do campo de fluxo, sem busca: O(1) por fantasma.
+// Cada fantasma só escreve nas próprias posições da tabela, então trechos
+// diferentes podem ser movidos em threads diferentes.
+void MoveGhostRange(GhostTable &ghosts, int begin, int end, float elapsedTime, const NavGrid &nav)
+{
+    for (int i = begin; i < end; ++i)
     {
-        if (freeze_ghosts_countdown > 0.0f) // Se os fantasmas estão parados, a colisão não conta
-        {
-            return false;
-        }
-        else
+        PROFILE_SCOPE("Ghost::move");
+        glm::vec3 position = glm::vec3(ghosts.x[i], ghosts.y[i], ghosts.z[i]);
+        int target = ghosts.target_cell[i];
+        float step = GHOST_CHASE_SPEED * elapsedTime;
+
+        for (int turn = 0; turn < 2 && step > 0.0f; ++turn)
         {
-            if (isFreeCamOn)
+            if (target < 0)
+            {
+                // Primeiro movimento: vai até o centro da própria célula
+                target = NavCellAt(nav, position);
+            }
+            else if (NavCellCenter(nav, target, position.y) == position)
+            {
+                int next = NavNextCell(nav, target);
+                if (next < 0 || next == target)
+                    break;
+                target = next;
+            }
+
+            glm::vec3 center = NavCellCenter(nav, target, position.y);
+            glm::vec3 offset = center - position;
+            float distance = glm::length(offset);
+            if (distance <= step)
             {
-                radius_bbox = 0.55;
+                position = center;
+                step -= distance;
             }
-            Sphere ghost_b_sphere = Sphere{current_position, radius_bbox};
-            return checkSphereToSphereCollision(ghost_b_sphere, pacman);
+            else
+            {
+                position += offset * (step / distance);
+                step = 0.0f;
+            }
+
+            if (std::abs(offset.z) >= std::abs(offset.x) && offset.z != 0.0f)
+                ghosts.rotation[i] = offset.z < 0.0f ? 3.14159f : 0.0f;
+            else if (offset.x != 0.0f)
+                ghosts.rotation[i] = offset.x > 0.0f ? 3.14159f / 2 : -3.14159f / 2;
         }
+
+        ghosts.x[i] = position.x;
+        ghosts.z[i] = position.z;
+        ghosts.target_cell[i] = target;
     }
-};
+}
 
-Ghost instanciateGhost(GhostType type)
+void MoveGhosts(GhostTable &ghosts, float elapsedTime, const NavGrid &nav)
 {
-    switch (type)
-    {
-    case FIRST:
-        return {GHOST, "ghost", glm::vec4(8.5f, -1.4f, 8.5f, 0.0f), glm::vec4(-8.5f, -1.4f, -8.5f, 0.0f), ghost_size};
+    PROFILE_FUNCTION();
+    std::copy(ghosts.x.begin(), ghosts.x.end(), ghosts.previous_x.begin());
+    std::copy(ghosts.z.begin(), ghosts.z.end(), ghosts.previous_z.begin());
+    if (game_over || freeze_ghosts_countdown > 0.0f)
+        return;
+
+    ParallelFor("MoveGhostRange", GhostCount(ghosts), GHOST_JOB_GRAIN, [&](int begin, int end)
+                { MoveGhostRange(ghosts, begin, end, elapsedTime, nav); });
+}
+
+// Algum fantasma tocou o Pac-Man? Todos são testados de uma vez pelos
+// kernels de simd_collisions.hpp.
+bool GhostsCaughtPacman(GhostTable &ghosts, Sphere pacman)
+{
+    PROFILE_FUNCTION();
+    if (freeze_ghosts_countdown > 0.0f) // Se os fantasmas estão parados, a colisão não conta
+        return false;
 
-    case SECOND:
-        return {GHOST2, "ghost", glm::vec4(3.2, -1.4f, 2.0f, 0.0f), glm::vec4(-3.35, -1.4f, -2.0f, 0.0f), ghost_size};
+    int count = GhostCount(ghosts);
+    if (isFreeCamOn)
+        std::fill(ghosts.hit_radius.begin(), ghosts.hit_radius.end(), 0.55f);
 
-    default:
-        return {GHOST, "ghost", glm::vec4(8.5f, -1.4f, 8.5f, 0.0f), glm::vec4(-8.5f, -1.4f, -8.5f, 0.0f), ghost_size};
+    SphereSoA spheres = {ghosts.x.data(), ghosts.y.data(), ghosts.z.data(), ghosts.hit_radius.data(), count};
+    SphereOverlapSpheres(pacman, spheres, ghosts.hit_mask.data());
+    for (uint32_t word : ghosts.hit_mask)
+    {
+        if (word != 0)
+            return true;
+    }
+    return false;
+}
+
+// "alpha" é a fração do passo de simulação já decorrida (veja
+// FixedTimestepAlpha()); a posição desenhada fica entre os dois últimos passos.
+void BuildGhostPackets(const GhostTable &ghosts, float alpha, const Frustum &frustum, RenderPacketList &list, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        float x = ghosts.previous_x[i] + (ghosts.x[i] - ghosts.previous_x[i]) * alpha;
+        float z = ghosts.previous_z[i] + (ghosts.z[i] - ghosts.previous_z[i]) * alpha;
+        float scale = ghosts.scale[i];
+        glm::mat4 model = Matrix_Translate(x, ghosts.y[i], z) * Matrix_Rotate_Y(ghosts.rotation[i]) * Matrix_Scale(scale, scale, scale);
+
+        MeshHandle mesh = ghosts.render.mesh[i];
+        list.packets[i] = {model, ghosts.render.object_type[i], mesh};
+        list.visible[i] = FrustumContainsSphere(frustum, glm::vec3(x, ghosts.y[i], z), MeshBoundingRadius(mesh) * scale);
     }
 }
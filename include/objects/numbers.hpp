@@ -5,10 +5,8 @@
 #include <vector>
 #include <limits>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <algorithm>
-#include <iomanip>
 
 // Headers das bibliotecas OpenGL
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
@@ -22,16 +20,190 @@
 #include "objects/objects.hpp"
 #include "globals/globals.hpp"
 #include "matrices.h"
+#include "utils/shader_utils.hpp"
+#include "utils/profiler.hpp"
 
 using namespace std;
 
+// O placar é desenhado em uma textura (render-to-texture) somente quando a
+// pontuação muda: os três dígitos 3D (os modelos mais pesados do jogo) são
+// renderizados uma vez, de frente e com projeção ortográfica, em um
+// framebuffer próprio. A cada quadro, o placar custa apenas um quadrilátero
+// texturizado por posição em que aparece.
+
+// Meias dimensões do quadrilátero do placar, no espaço do modelo. Os dígitos
+// ficam a 1.0 de distância um do outro e têm cerca de 0.5 x 0.6 unidades.
+const float SCORE_HALF_WIDTH = 1.5f;
+const float SCORE_HALF_HEIGHT = 0.4f;
+// Metade da espessura dos dígitos: a face da frente fica em z = 0.1.
+const float SCORE_HALF_DEPTH = 0.1f;
+
+// Mesma proporção do quadrilátero (3.0 x 0.8)
+const int SCORE_TEXTURE_WIDTH = 480;
+const int SCORE_TEXTURE_HEIGHT = 128;
+
+GLuint g_ScoreProgramID = 0;
+GLint g_score_model_uniform;
+GLint g_score_view_uniform;
+GLint g_score_projection_uniform;
+
+GLuint g_ScoreVertexArrayID = 0;
+GLuint g_ScoreFramebufferID = 0;
+GLuint g_ScoreTextureID = 0;
+GLuint g_ScoreDepthRenderbufferID = 0;
+GLint g_ScoreTextureUnit = 0;
+
+// Estado com que a textura foi gerada pela última vez. A iluminação dos
+// dígitos muda com a free cam, e recarregar os shaders também exige refazer
+// a textura.
+int g_ScoreTextureCount = -1;
+bool g_ScoreTextureFreeCam = false;
+GLuint g_ScoreTextureProgram = 0;
+
 void renderCount(int current_count, char *count_first_digit, char *count_second_digit, char *count_third_digit)
 {
-    std::ostringstream oss;
-    oss << std::setfill('0') << std::setw(3) << current_count;
-    std::string numStr = oss.str();
+    PROFILE_FUNCTION();
+    int count = current_count % 1000;
+
+    snprintf(count_first_digit, 4, "N_%c", '0' + count % 10);
+    snprintf(count_second_digit, 4, "N_%c", '0' + (count / 10) % 10);
+    snprintf(count_third_digit, 4, "N_%c", '0' + count / 100);
+}
+
+void SetupScoreProgram(GLuint program_id)
+{
+    g_score_model_uniform = glGetUniformLocation(program_id, "model");
+    g_score_view_uniform = glGetUniformLocation(program_id, "view");
+    g_score_projection_uniform = glGetUniformLocation(program_id, "projection");
+
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "ScoreTexture"), g_ScoreTextureUnit);
+    glUseProgram(0);
+
+    // Força a regeneração da textura com os shaders novos
+    g_ScoreTextureCount = -1;
+}
+
+// Deve ser chamada após LoadTexturesFromFiles(), pois ocupa a próxima unidade
+// de textura livre com a imagem do placar.
+void LoadScoreDisplay()
+{
+    g_ScoreTextureUnit = g_NumLoadedTextures++;
+
+    glGenTextures(1, &g_ScoreTextureID);
+    glActiveTexture(GL_TEXTURE0 + g_ScoreTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, g_ScoreTextureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCORE_TEXTURE_WIDTH, SCORE_TEXTURE_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenRenderbuffers(1, &g_ScoreDepthRenderbufferID);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_ScoreDepthRenderbufferID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCORE_TEXTURE_WIDTH, SCORE_TEXTURE_HEIGHT);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &g_ScoreFramebufferID);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_ScoreFramebufferID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_ScoreTextureID, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_ScoreDepthRenderbufferID);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        fprintf(stderr, "WARNING: Score framebuffer incomplete.\n");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    g_ScoreProgramID = LoadGpuProgram("../../resources/shaders/score_vertex.glsl",
+                                      "../../resources/shaders/score_fragment.glsl");
+    SetupScoreProgram(g_ScoreProgramID);
+
+    // Core profile exige um VAO ligado mesmo sem atributos de vértice.
+    glGenVertexArrays(1, &g_ScoreVertexArrayID);
+}
+
+// Redesenha os dígitos na textura do placar se a pontuação (ou a iluminação)
+// mudou desde a última vez. Deve ser chamada com g_GpuProgramID em uso e
+// antes do envio das matrizes "view" e "projection" do quadro, que são
+// sobrescritas aqui.
+void UpdateScoreTexture(int current_count, bool free_cam)
+{
+    if (current_count == g_ScoreTextureCount && free_cam == g_ScoreTextureFreeCam && g_GpuProgramID == g_ScoreTextureProgram)
+        return;
+
+    PROFILE_FUNCTION();
+    g_ScoreTextureCount = current_count;
+    g_ScoreTextureFreeCam = free_cam;
+    g_ScoreTextureProgram = g_GpuProgramID;
+
+    char digits[3][4];
+    renderCount(current_count, digits[0], digits[1], digits[2]);
+
+    GLint previous_framebuffer;
+    GLint previous_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, g_ScoreFramebufferID);
+    glViewport(0, 0, SCORE_TEXTURE_WIDTH, SCORE_TEXTURE_HEIGHT);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Câmera de frente para os dígitos, com a mesma área do quadrilátero
+    glm::mat4 view = Matrix_Camera_View(glm::vec4(0.0f, 0.0f, 2.0f, 1.0f), glm::vec4(0.0f, 0.0f, -1.0f, 0.0f), glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+    glm::mat4 projection = Matrix_Orthographic(-SCORE_HALF_WIDTH, SCORE_HALF_WIDTH, -SCORE_HALF_HEIGHT, SCORE_HALF_HEIGHT, -0.1f, -10.0f);
+    glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1i(g_is_free_cam_on_uniform, free_cam);
+
+    // Unidades à direita, centenas à esquerda
+    const int object_ids[3] = {COUNT_1, COUNT_2, COUNT_3};
+    for (int i = 0; i < 3; ++i)
+    {
+        glm::mat4 model = Matrix_Translate(1.0f - i, 0.0f, 0.0f);
+        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
+        glUniform1i(g_object_id_uniform, object_ids[i]);
+        DrawVirtualObject(digits[i]);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+}
+
+// Desenha o placar nas mesmas posições em que ficavam os dígitos 3D: deitado
+// no centro do chão (câmera de cima) ou, com a free cam, de pé nas duas
+// bordas do labirinto. Restaura g_GpuProgramID ao final.
+void RenderScore(const glm::mat4 &view, const glm::mat4 &projection, bool free_cam, float farplane)
+{
+    glm::mat4 models[2];
+    int model_count = 0;
+
+    glm::mat4 quad = Matrix_Translate(0.0f, 0.0f, SCORE_HALF_DEPTH) * Matrix_Scale(SCORE_HALF_WIDTH, SCORE_HALF_HEIGHT, 1.0f);
+    if (free_cam)
+    {
+        models[model_count++] = Matrix_Translate(0.0f, 2.0f, farplane / 4) * quad;
+        models[model_count++] = Matrix_Translate(0.0f, 2.0f, -farplane / 4) * Matrix_Rotate_Y(3.14159f) * quad;
+    }
+    else
+    {
+        models[model_count++] = Matrix_Translate(0.0f, -1.0f, 0.0f) * Matrix_Rotate_X(3.14159f / 2) * Matrix_Rotate_Z(3.14159f) * Matrix_Rotate_Y(3.14159f) * quad;
+    }
+
+    glUseProgram(g_ScoreProgramID);
+    glUniformMatrix4fv(g_score_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_score_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+
+    // Os dígitos 3D eram visíveis dos dois lados
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(g_ScoreVertexArrayID);
+    for (int i = 0; i < model_count; ++i)
+    {
+        glUniformMatrix4fv(g_score_model_uniform, 1, GL_FALSE, glm::value_ptr(models[i]));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glBindVertexArray(0);
+    glEnable(GL_CULL_FACE);
+
+    g_FrameDrawCalls += model_count;
+    g_FrameTriangles += 2 * model_count;
 
-    snprintf(count_first_digit, 4, "N_%c", numStr[2]);
-    snprintf(count_second_digit, 4, "N_%c", numStr[1]);
-    snprintf(count_third_digit, 4, "N_%c", numStr[0]);
+    glUseProgram(g_GpuProgramID);
 }
@@ -2,11 +2,14 @@
 
 #include <string>
 
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>
 #include <external/GLFW/glfw3.h>
+#endif
 #include <external/glm/gtc/type_ptr.hpp>
 
 #include "globals/globals.hpp"
+#include "utils/profiler.hpp"
 
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
@@ -160,19 +163,78 @@ void ComputeNormals(ObjModel *model)
 // estes são acessados.
 std::map<std::string, SceneObject> g_VirtualScene;
 
+// Referência a um objeto de g_VirtualScene guardada pelas entidades. Os nós
+// de um std::map não mudam de endereço, então o ponteiro continua válido
+// enquanto o objeto existir; desenhar por ele evita procurar o nome no
+// dicionário a cada chamada.
+typedef const SceneObject *MeshHandle;
+
+// Usada por LoadLevel() para conferir as malhas das paredes
+bool IsMeshLoaded(const char *object_name)
+{
+    return g_VirtualScene.count(object_name) != 0;
+}
+
+// Um nome que não está na cena é um erro de programação ou de fase: com
+// operator[] ele viraria um objeto vazio, com AABB nula (uma parede invisível
+// e sem tamanho), por isso paramos aqui.
+MeshHandle FindMesh(const std::string &object_name)
+{
+    std::map<std::string, SceneObject>::const_iterator it = g_VirtualScene.find(object_name);
+    if (it == g_VirtualScene.end())
+    {
+        fprintf(stderr, "Erro: objeto '%s' não foi carregado na cena.\n", object_name.c_str());
+        throw std::runtime_error("Objeto não carregado.");
+    }
+    return &it->second;
+}
+
+// Paredes, cerejas e fantasmas são guardados em tabelas de arrays (SoA), uma
+// por tipo de entidade, como as bolinhas em pellet_pool.hpp: a posição i de
+// cada array é a entidade i. Cada sistema (colisão, movimento, desenho) lê
+// somente os arrays de que precisa. Este é o componente de desenho comum a
+// todas as tabelas: o objeto da cena e o "object_id" do Fragment Shader.
+struct RenderComponents
+{
+    std::vector<int> object_type;
+    std::vector<MeshHandle> mesh;
+};
+
+void AddRenderComponent(RenderComponents &render, int object_type, const std::string &object_name)
+{
+    render.object_type.push_back(object_type);
+    render.mesh.push_back(FindMesh(object_name));
+}
+
+// Remoção O(1): a última entidade ocupa o lugar da removida.
+void RemoveRenderComponent(RenderComponents &render, int index)
+{
+    render.object_type[index] = render.object_type.back();
+    render.mesh[index] = render.mesh.back();
+    render.object_type.pop_back();
+    render.mesh.pop_back();
+}
+
+void ClearRenderComponents(RenderComponents &render)
+{
+    render.object_type.clear();
+    render.mesh.clear();
+}
+
+#ifndef PACMAN_HEADLESS
 // Função que desenha um objeto armazenado em g_VirtualScene. Veja definição
 // dos objetos na função BuildTrianglesAndAddToVirtualScene().
-void DrawVirtualObject(const char *object_name)
+void DrawSceneObject(const SceneObject &object)
 {
     // "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
     // vértices apontados pelo VAO criado pela função BuildTrianglesAndAddToVirtualScene(). Veja
     // comentários detalhados dentro da definição de BuildTrianglesAndAddToVirtualScene().
-    glBindVertexArray(g_VirtualScene[object_name].vertex_array_object_id);
+    glBindVertexArray(object.vertex_array_object_id);
 
     // Setamos as variáveis "bbox_min" e "bbox_max" do fragment shader
     // com os parâmetros da axis-aligned bounding box (AABB) do modelo.
-    glm::vec3 bbox_min = g_VirtualScene[object_name].bbox_min;
-    glm::vec3 bbox_max = g_VirtualScene[object_name].bbox_max;
+    glm::vec3 bbox_min = object.bbox_min;
+    glm::vec3 bbox_max = object.bbox_max;
     glUniform4f(g_bbox_min_uniform, bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
     glUniform4f(g_bbox_max_uniform, bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
 
@@ -182,22 +244,36 @@ void DrawVirtualObject(const char *object_name)
     // a documentação da função glDrawElements() em
     // http://docs.gl/gl3/glDrawElements.
     glDrawElements(
-        g_VirtualScene[object_name].rendering_mode,
-        g_VirtualScene[object_name].num_indices,
+        object.rendering_mode,
+        object.num_indices,
         GL_UNSIGNED_INT,
-        (void *)(g_VirtualScene[object_name].first_index * sizeof(GLuint)));
+        (void *)(object.first_index * sizeof(GLuint)));
+
+    g_FrameDrawCalls += 1;
+    if (object.rendering_mode == GL_TRIANGLES)
+        g_FrameTriangles += object.num_indices / 3;
 
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
     // alterar o mesmo. Isso evita bugs.
     glBindVertexArray(0);
 }
 
-// Constrói triângulos para futura renderização a partir de um ObjModel.
+void DrawVirtualObject(const char *object_name)
+{
+    DrawSceneObject(g_VirtualScene[object_name]);
+}
+#endif
+
+// Constrói triângulos para futura renderização a partir de um ObjModel. Sem
+// contexto OpenGL (PACMAN_HEADLESS), somente as AABBs dos objetos são
+// registradas em g_VirtualScene; as paredes dependem delas para as colisões.
 void BuildTrianglesAndAddToVirtualScene(ObjModel *model)
 {
-    GLuint vertex_array_object_id;
+    GLuint vertex_array_object_id = 0;
+#ifndef PACMAN_HEADLESS
     glGenVertexArrays(1, &vertex_array_object_id);
     glBindVertexArray(vertex_array_object_id);
+#endif
 
     std::vector<GLuint> indices;
     std::vector<float> model_coefficients;
@@ -282,6 +358,7 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel *model)
         g_VirtualScene[model->shapes[shape].name] = theobject;
     }
 
+#ifndef PACMAN_HEADLESS
     GLuint VBO_model_coefficients_id;
     glGenBuffers(1, &VBO_model_coefficients_id);
     glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
@@ -334,22 +411,13 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel *model)
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
     // alterar o mesmo. Isso evita bugs.
     glBindVertexArray(0);
+#endif
 }
 
-void LoadObjects () {
-    // Construímos a representação de objetos geométricos através de malhas de triângulos
-    ObjModel spheremodel("../../resources/models/food/sphere.obj");
-    ComputeNormals(&spheremodel);
-    BuildTrianglesAndAddToVirtualScene(&spheremodel);
-
-    ObjModel planemodel("../../resources/models/skybox/plane.obj");
-    ComputeNormals(&planemodel);
-    BuildTrianglesAndAddToVirtualScene(&planemodel);
-
-    ObjModel cubemodel("../../resources/models/skybox/cube.obj");
-    ComputeNormals(&cubemodel);
-    BuildTrianglesAndAddToVirtualScene(&cubemodel);
-
+// Peças do labirinto. As AABBs delas são as caixas de colisão das paredes,
+// então também são carregadas sem contexto OpenGL.
+void LoadLabyrinthObjects()
+{
     ObjModel piecetwo("../../resources/models/labyrinth/p2.obj");
     ComputeNormals(&piecetwo);
     BuildTrianglesAndAddToVirtualScene(&piecetwo);
@@ -365,11 +433,13 @@ void LoadObjects () {
     ObjModel piecethreerotated("../../resources/models/labyrinth/p3-rotated.obj");
     ComputeNormals(&piecethreerotated);
     BuildTrianglesAndAddToVirtualScene(&piecethreerotated);
+}
 
-    ObjModel pacmodel("../../resources/models/pacman/newpacman.obj");
-    ComputeNormals(&pacmodel);
-    BuildTrianglesAndAddToVirtualScene(&pacmodel);
-
+// Fantasmas e cerejas: as tabelas guardam a malha de cada entidade, e a AABB
+// dela dá o raio do teste de visibilidade (render_packets.hpp), então também
+// são carregados sem contexto OpenGL.
+void LoadEntityObjects()
+{
     ObjModel ghostmodel("../../resources/models/ghost/newghost.obj");
     ComputeNormals(&ghostmodel);
     BuildTrianglesAndAddToVirtualScene(&ghostmodel);
@@ -377,6 +447,26 @@ void LoadObjects () {
     ObjModel cherrymodel("../../resources/models/food/cherry.obj");
     ComputeNormals(&cherrymodel);
     BuildTrianglesAndAddToVirtualScene(&cherrymodel);
+}
+
+void LoadObjects () {
+    PROFILE_FUNCTION();
+    // Construímos a representação de objetos geométricos através de malhas de triângulos
+    ObjModel spheremodel("../../resources/models/food/sphere.obj");
+    ComputeNormals(&spheremodel);
+    BuildTrianglesAndAddToVirtualScene(&spheremodel);
+
+    ObjModel planemodel("../../resources/models/skybox/plane.obj");
+    ComputeNormals(&planemodel);
+    BuildTrianglesAndAddToVirtualScene(&planemodel);
+
+    LoadLabyrinthObjects();
+
+    ObjModel pacmodel("../../resources/models/pacman/newpacman.obj");
+    ComputeNormals(&pacmodel);
+    BuildTrianglesAndAddToVirtualScene(&pacmodel);
+
+    LoadEntityObjects();
 
     ObjModel zeromodel("../../resources/models/numbers/000.obj");
     ComputeNormals(&zeromodel);
@@ -1,6 +1,10 @@
+#pragma once
+
 // Headers das bibliotecas OpenGL
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
@@ -8,8 +12,10 @@
 #include <external/glm/gtc/type_ptr.hpp>
 
 #include "collisions/collisions.hpp"
+#include "objects/wall.hpp"
 #include "globals/globals.hpp"
 #include "matrices.h"
+#include "utils/profiler.hpp"
 
 glm::vec4 calculateBezierPosition(glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm::vec4 p4, float t)
 {
@@ -21,75 +27,101 @@ glm::vec4 calculateBezierPosition(glm::vec4 p1, glm::vec4 p2, glm::vec4 p3, glm:
     return b03 * p1 + b13 * p2 + b23 * p3 + b33 * p4;
 }
 
-void BoostPacmanSpeed(float &previousTime)
+// Teclas de movimento e direções da câmera lidas no início do quadro. A
+// simulação só enxerga a entrada por esta cópia, nunca pelos globais que os
+// callbacks alteram (veja simulation.hpp).
+struct PacmanInput
 {
-    static bool speedChanged = false;
-    static float elapsedTime = 0.0f;
-
-    float currentTime = (float)glfwGetTime();
-    float frameElapsedTime = currentTime - previousTime;
-    previousTime = currentTime;
-
-    if (!speedChanged)
+    bool forward;
+    bool backward;
+    bool right;
+    bool left;
+    glm::vec4 forward_unit; // Sentido de "frente" no plano do chão
+    glm::vec4 side_unit;    // Sentido de "esquerda"
+};
+
+// Mantém a velocidade aumentada por PACMAN_BOOST_DURATION segundos de
+// simulação depois que uma cereja é comida.
+void BoostPacmanSpeed(float elapsedTime)
+{
+    if (!pacman_boost_active)
     {
         PACMAN_SPEED = PACMAN_BOOST;
-        speedChanged = true;
-        elapsedTime = 0.0f;
+        pacman_boost_active = true;
+        pacman_boost_elapsed = 0.0f;
     }
 
-    elapsedTime += frameElapsedTime;
+    pacman_boost_elapsed += elapsedTime;
 
-    if (elapsedTime >= 1.5f)
+    if (pacman_boost_elapsed >= PACMAN_BOOST_DURATION)
     {
         PACMAN_SPEED = PACMAN_ORIGINAL_SPEED;
-        speedChanged = false;
+        pacman_boost_active = false;
         shouldBoostSpeed = false;
         // ReloadShaders();
     }
 }
 
-void MovePacman(glm::vec4 camera_view_unit, glm::vec4 camera_side_view_unit, float elapsedTime, std::vector<glm::vec4> collision_directions)
+// Tamanho e, com a câmera livre, direção do Pac-Man, que acompanha a câmera.
+// Só dependem de isFreeCamOn e dos ângulos da câmera, gravados com a entrada
+// (input_record.hpp), então são recalculados a cada passo de simulação.
+void UpdatePacmanCameraMode()
+{
+    pacman_size = isFreeCamOn ? pacman_freecam_size : pacman_lookat_size;
+    if (isFreeCamOn)
+    {
+        float x = g_CameraDistance * cos(g_CameraPhi) * sin(g_CameraTheta);
+        float z = g_CameraDistance * cos(g_CameraPhi) * cos(g_CameraTheta);
+        pacman_rotation = -atan2(-z, -x);
+    }
+}
+
+// Soma os deslocamentos das teclas pressionadas, descarta o que empurra
+// contra os limites da arena ("collision_directions") e move a esfera do
+// Pac-Man pelo labirinto com o teste contínuo de moveSphereThroughWalls().
+void MovePacman(const PacmanInput &input, float elapsedTime, std::vector<glm::vec4> collision_directions)
 {
+    PROFILE_FUNCTION();
     if (game_over)
         return;
 
-    if (movePacmanBackward)
+    glm::vec4 direction = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+
+    if (input.backward)
     {
-        pacman_movement = -camera_view_unit * PACMAN_SPEED * elapsedTime;
-        pacman_movement = cancelCollisionMovement(pacman_movement, collision_directions);
-        pacman_position_c += pacman_movement;
+        direction -= input.forward_unit;
 
         if (!isFreeCamOn)
             pacman_rotation = -3.14159f / 2;
     }
 
-    if (movePacmanForward)
+    if (input.forward)
     {
-        pacman_movement = camera_view_unit * PACMAN_SPEED * elapsedTime;
-        pacman_movement = cancelCollisionMovement(pacman_movement, collision_directions);
-        pacman_position_c += pacman_movement;
+        direction += input.forward_unit;
 
         if (!isFreeCamOn)
             pacman_rotation = 3.14159f / 2;
     }
 
-    if (movePacmanRight)
+    if (input.right)
     {
-        pacman_movement = -camera_side_view_unit * PACMAN_SPEED * elapsedTime;
-        pacman_movement = cancelCollisionMovement(pacman_movement, collision_directions);
-        pacman_position_c += pacman_movement;
+        direction -= input.side_unit;
 
         if (!isFreeCamOn)
             pacman_rotation = 0.0f;
     }
 
-    if (movePacmanLeft)
+    if (input.left)
     {
-        pacman_movement = camera_side_view_unit * PACMAN_SPEED * elapsedTime;
-        pacman_movement = cancelCollisionMovement(pacman_movement, collision_directions);
-        pacman_position_c += pacman_movement;
+        direction += input.side_unit;
 
         if (!isFreeCamOn)
             pacman_rotation = 3.14159f;
     }
+
+    pacman_movement = cancelCollisionMovement(direction * PACMAN_SPEED * elapsedTime, collision_directions);
+
+    Sphere pacman_sphere = {pacman_position_c, pacman_size + 0.1f};
+    glm::vec3 center = moveSphereThroughWalls(pacman_sphere, glm::vec3(pacman_movement));
+    pacman_position_c = glm::vec4(center, 1.0f);
 }
@@ -0,0 +1,95 @@
+#pragma once
+
+// Conjunto das bolinhas do labirinto em estrutura de arrays (SoA). Cada
+// bolinha recebe um "handle" fixo ao ser criada: é o índice dela nos arrays
+// de centro e raio, no layout enviado à GPU (veja LoadPelletLayout()) e na
+// máscara de bits de bolinhas vivas. Remover uma bolinha nunca move as
+// outras; apenas limpa o seu bit e a retira da lista densa de vivas.
+
+#include <vector>
+#include <cstdint>
+
+#include <external/glm/vec3.hpp>
+
+struct PelletPool
+{
+    // Indexados pelo handle
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+    std::vector<uint32_t> alive_mask; // Um bit por handle
+    std::vector<int> live_slot;       // Posição em "live", ou -1 se comida
+
+    // Handles das bolinhas vivas, sem ordem definida
+    std::vector<int> live;
+
+    // Rascunho de checkLittleBallsCollision(): handles tocados pelo Pac-Man
+    // no passo, reaproveitado para não alocar a cada passo
+    std::vector<int> eaten;
+};
+
+void ClearPelletPool(PelletPool &pool)
+{
+    pool.center_x.clear();
+    pool.center_y.clear();
+    pool.center_z.clear();
+    pool.radius.clear();
+    pool.alive_mask.clear();
+    pool.live_slot.clear();
+    pool.live.clear();
+    pool.eaten.clear();
+}
+
+int AddPellet(PelletPool &pool, glm::vec3 center, float radius)
+{
+    int handle = (int)pool.radius.size();
+    pool.center_x.push_back(center.x);
+    pool.center_y.push_back(center.y);
+    pool.center_z.push_back(center.z);
+    pool.radius.push_back(radius);
+
+    if (handle % 32 == 0)
+        pool.alive_mask.push_back(0u);
+    pool.alive_mask[handle / 32] |= 1u << (handle % 32);
+
+    pool.live_slot.push_back((int)pool.live.size());
+    pool.live.push_back(handle);
+    return handle;
+}
+
+int PelletCapacity(const PelletPool &pool)
+{
+    return (int)pool.radius.size();
+}
+
+int LivePelletCount(const PelletPool &pool)
+{
+    return (int)pool.live.size();
+}
+
+bool IsPelletAlive(const PelletPool &pool, int handle)
+{
+    return (pool.alive_mask[handle / 32] >> (handle % 32)) & 1u;
+}
+
+glm::vec3 PelletCenter(const PelletPool &pool, int handle)
+{
+    return glm::vec3(pool.center_x[handle], pool.center_y[handle], pool.center_z[handle]);
+}
+
+// O(1): a última bolinha viva ocupa a posição da removida na lista densa.
+// Retorna a palavra da máscara de bits que mudou.
+int RemovePellet(PelletPool &pool, int handle)
+{
+    int slot = pool.live_slot[handle];
+    int moved = pool.live.back();
+    pool.live[slot] = moved;
+    pool.live_slot[moved] = slot;
+    pool.live.pop_back();
+    pool.live_slot[handle] = -1;
+
+    int word = handle / 32;
+    pool.alive_mask[word] &= ~(1u << (handle % 32));
+    return word;
+}
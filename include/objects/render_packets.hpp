@@ -0,0 +1,121 @@
+#pragma once
+
+// Pacotes de desenho: tudo que a thread principal precisa para desenhar um
+// objeto (matriz de modelagem, tipo e malha), calculado antes, em jobs (veja
+// job_system.hpp), junto com o teste de visibilidade contra o frustum da
+// câmera. Só a thread principal chama OpenGL; ela apenas percorre os pacotes
+// visíveis em DrawRenderPackets().
+
+#ifndef PACMAN_HEADLESS
+#include <external/glad/glad.h> // Criação de contexto OpenGL 3.3
+#endif
+
+#include <vector>
+#include <cstdint>
+
+#include <external/glm/mat4x4.hpp>
+#include <external/glm/vec4.hpp>
+#include <external/glm/gtc/type_ptr.hpp>
+
+#include "objects/objects.hpp"
+#include "globals/globals.hpp"
+
+// Os seis planos do volume de visualização, com a normal para dentro: um
+// ponto p está dentro se dot(plane, (p, 1)) >= 0 para todos.
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// Extrai os planos de "clip" = projection * view (método de Gribb e
+// Hartmann): um ponto está dentro se -w <= x, y, z <= w em coordenadas de
+// recorte. Serve tanto para a projeção perspectiva quanto para a ortográfica.
+Frustum ExtractFrustum(const glm::mat4 &clip)
+{
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+        row[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0]; // Esquerda
+    frustum.planes[1] = row[3] - row[0]; // Direita
+    frustum.planes[2] = row[3] + row[1]; // Baixo
+    frustum.planes[3] = row[3] - row[1]; // Cima
+    frustum.planes[4] = row[3] + row[2]; // Near
+    frustum.planes[5] = row[3] - row[2]; // Far
+    for (glm::vec4 &plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+bool FrustumContainsSphere(const Frustum &frustum, glm::vec3 center, float radius)
+{
+    for (const glm::vec4 &plane : frustum.planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Conservador: a caixa só é descartada se estiver inteira atrás de um plano.
+bool FrustumContainsAABB(const Frustum &frustum, const AABB &box)
+{
+    for (const glm::vec4 &plane : frustum.planes)
+    {
+        // Canto da caixa mais à frente na direção da normal
+        glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                         plane.y >= 0.0f ? box.max.y : box.min.y,
+                         plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// Raio de uma esfera centrada na origem do modelo que contém a malha.
+float MeshBoundingRadius(MeshHandle mesh)
+{
+    glm::vec3 extent = glm::max(glm::abs(mesh->bbox_min), glm::abs(mesh->bbox_max));
+    return glm::length(extent);
+}
+
+// Objetos por job ao montar os pacotes
+const int RENDER_PACKET_JOB_GRAIN = 128;
+
+struct RenderPacket
+{
+    glm::mat4 model;
+    int object_type;
+    MeshHandle mesh;
+};
+
+// Um pacote por objeto, na ordem da tabela de origem; "visible" é 0 para os
+// que ficaram fora do frustum. O tamanho é fixado antes dos jobs, que então
+// escrevem cada um no seu trecho sem sincronização.
+struct RenderPacketList
+{
+    std::vector<RenderPacket> packets;
+    std::vector<uint8_t> visible;
+};
+
+void ResizeRenderPackets(RenderPacketList &list, int count)
+{
+    list.packets.resize(count);
+    list.visible.resize(count);
+}
+
+#ifndef PACMAN_HEADLESS
+void DrawRenderPackets(const RenderPacketList &list)
+{
+    for (size_t i = 0; i < list.packets.size(); ++i)
+    {
+        if (!list.visible[i])
+            continue;
+        const RenderPacket &packet = list.packets[i];
+        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(packet.model));
+        glUniform1i(g_object_id_uniform, packet.object_type);
+        DrawSceneObject(*packet.mesh);
+    }
+}
+#endif
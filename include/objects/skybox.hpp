@@ -0,0 +1,68 @@
+#pragma once
+
+// Headers das bibliotecas OpenGL
+#include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
+#include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+
+// Headers da biblioteca GLM: criação de matrizes e vetores.
+#include <external/glm/mat4x4.hpp>
+#include <external/glm/vec4.hpp>
+#include <external/glm/gtc/type_ptr.hpp>
+#include <external/glm/gtc/matrix_inverse.hpp>
+
+#include "utils/shader_utils.hpp"
+#include "globals/globals.hpp"
+
+// O skybox é um cubemap (unidade de textura 0, veja LoadTexturesFromFiles())
+// amostrado por um triângulo que cobre a tela inteira. Ele é desenhado por
+// último, no far plane, para que o teste de profundidade descarte todos os
+// pixels já cobertos pelo chão, labirinto e personagens.
+GLuint g_SkyProgramID = 0;
+GLint g_sky_inverse_view_projection_uniform;
+GLint g_sky_half_size_uniform;
+
+// Core profile exige um VAO ligado mesmo sem atributos de vértice.
+GLuint g_SkyVertexArrayID = 0;
+
+void SetupSkyProgram(GLuint program_id)
+{
+    g_sky_inverse_view_projection_uniform = glGetUniformLocation(program_id, "inverse_view_projection");
+    g_sky_half_size_uniform = glGetUniformLocation(program_id, "sky_half_size");
+
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "SkyBoxCubemap"), 0);
+    glUseProgram(0);
+}
+
+void LoadSkybox()
+{
+    g_SkyProgramID = LoadGpuProgram("../../resources/shaders/sky_vertex.glsl",
+                                    "../../resources/shaders/sky_fragment.glsl");
+    SetupSkyProgram(g_SkyProgramID);
+
+    glGenVertexArrays(1, &g_SkyVertexArrayID);
+}
+
+// Deve ser chamada depois de toda a geometria opaca.
+void RenderSky(const glm::mat4 &view, const glm::mat4 &projection, float half_size)
+{
+    glm::mat4 inverse_view_projection = glm::inverse(projection * view);
+
+    glUseProgram(g_SkyProgramID);
+    glUniformMatrix4fv(g_sky_inverse_view_projection_uniform, 1, GL_FALSE, glm::value_ptr(inverse_view_projection));
+    glUniform1f(g_sky_half_size_uniform, half_size);
+
+    // GL_LEQUAL: passa somente onde o Z-buffer ainda tem o valor de limpeza (1.0)
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+
+    glBindVertexArray(g_SkyVertexArrayID);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    g_FrameDrawCalls += 1;
+    g_FrameTriangles += 1;
+
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
@@ -1,6 +1,10 @@
+#pragma once
+
 // Headers das bibliotecas OpenGL
+#ifndef PACMAN_HEADLESS
 #include <external/glad/glad.h>  // Criação de contexto OpenGL 3.3
 #include <external/GLFW/glfw3.h> // Criação de janelas do sistema operacional
+#endif
 
 // Headers da biblioteca GLM: criação de matrizes e vetores.
 #include <external/glm/mat4x4.hpp>
@@ -8,138 +12,125 @@
 #include <external/glm/gtc/type_ptr.hpp>
 
 #include "objects/objects.hpp"
+#include "objects/render_packets.hpp"
+#include "game/level.hpp"
 #include "globals/globals.hpp"
 #include "matrices.h"
+#include "utils/profiler.hpp"
+#include "collisions/collisions.hpp"
+#include "collisions/spatial_grid.hpp"
 
-class Wall
+// Tabela das paredes. Elas não se movem: a matriz de modelagem e a caixa de
+// colisão são calculadas uma vez, ao criar a parede.
+struct WallTable
 {
-public:
-    // Atributos:
-    glm::mat4 modelMatrix;
-    int objectId;
-    int objectType;
-    std::string objectName;
-    AABB wall_bbox;
-
-    // Métodos:
-
-    // Construtor
-    Wall(glm::mat4 modelMatrix, int objectId, int objectType, std::string objectName, std::map<std::string, SceneObject> &g_VirtualScene)
-        : modelMatrix(modelMatrix), objectId(objectId), objectType(objectType), objectName(objectName)
-    {
-        this->wall_bbox = setBoundingBox(g_VirtualScene);
-    }
+    std::vector<AABB> bounds;      // Colisão (também copiadas para g_WallGrid)
+    std::vector<glm::mat4> model;  // Desenho
+    RenderComponents render;
+};
 
-    void render()
-    {
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(modelMatrix));
-        glUniform1i(g_object_id_uniform, objectType);
-        DrawVirtualObject(objectName.c_str());
-    }
+void ClearWalls(WallTable &walls)
+{
+    walls.bounds.clear();
+    walls.model.clear();
+    ClearRenderComponents(walls.render);
+}
+
+// A caixa da parede é a AABB do objeto "object_name" levada pela matriz
+// "model" (somente translação e escala).
+void AddWall(WallTable &walls, glm::mat4 model, int object_type, const std::string &object_name)
+{
+    const SceneObject &object = *FindMesh(object_name);
+    glm::vec4 min_corner = glm::vec4(object.bbox_min.x, object.bbox_min.y, object.bbox_min.z, 1.0f);
+    glm::vec4 max_corner = glm::vec4(object.bbox_max.x, object.bbox_max.y, object.bbox_max.z, 1.0f);
+    walls.bounds.push_back({model * min_corner, model * max_corner});
+    walls.model.push_back(model);
+    AddRenderComponent(walls.render, object_type, object_name);
+}
+
+// Broadphase das paredes (veja spatial_grid.hpp). As paredes não se movem,
+// então a grade é montada uma única vez, em instanciateWalls().
+WallGrid g_WallGrid;
 
-private:
-    AABB setBoundingBox(std::map<std::string, SceneObject> &g_VirtualScene)
+void instanciateWalls(WallTable &walls, const LevelView &level)
+{
+    ClearWalls(walls);
+    for (uint32_t i = 0; i < level.header->wall_count; ++i)
     {
-        glm::vec3 bbox_min = g_VirtualScene[objectName].bbox_min;
-        glm::vec3 bbox_max = g_VirtualScene[objectName].bbox_max;
-        glm::vec4 minCorner = glm::vec4(bbox_min.x, bbox_min.y, bbox_min.z, 1.0f);
-        glm::vec4 maxCorner = glm::vec4(bbox_max.x, bbox_max.y, bbox_max.z, 1.0f);
-        return {modelMatrix * minCorner, modelMatrix * maxCorner};
+        // As malhas já foram conferidas uma vez, por LoadLevel()
+        const LevelWall &wall = level.walls[i];
+        glm::mat4 model = Matrix_Translate(wall.translate[0], wall.translate[1], wall.translate[2]) *
+                          Matrix_Scale(wall.scale[0], wall.scale[1], wall.scale[2]);
+        AddWall(walls, model, wall.object_type, wall.mesh);
     }
-};
 
-std::vector<Wall> instanciateWalls()
+    BuildWallGrid(g_WallGrid, walls.bounds);
+}
+
+// Desloca a esfera "s" por "displacement" sem atravessar nenhuma parede,
+// e retorna o novo centro. A cada contato a esfera para logo antes da
+// parede e o que resta do deslocamento é projetado no plano da parede, para
+// que ela deslize ao longo dela. Como o teste é contínuo, um passo grande
+// (quadro lento, velocidade aumentada pela cereja) não atravessa paredes finas.
+glm::vec3 moveSphereThroughWalls(Sphere s, glm::vec3 displacement)
 {
-    std::vector<Wall> walls;
-    int objectIdCounter = 0;
-    const float FLOOR_Y = -1.0f;
-    const float WALL_HEIGHT = 0.5f;
-    const float MAX_X = 10.0f, MIN_X = -10.0f;
-    const float MAX_Z = 10.0f, MIN_Z = -10.0f;
-
-    auto createWall = [&objectIdCounter](float tx, float ty, float tz, float sx, float sy, float sz,
-                                         const std::string &texture, int labyrinth) -> Wall
-    {
-        return {Matrix_Translate(tx, ty, tz) * Matrix_Scale(sx, sy, sz),
-                objectIdCounter++, labyrinth, texture, g_VirtualScene};
-    };
-
-    std::vector<std::tuple<float, float, float, float, float, float, std::string, int>> baseWalls = {
-        {3.5f, FLOOR_Y, 2.9f, 0.6f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {3.0f, FLOOR_Y, 4.3f, 0.4f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {5.7f, FLOOR_Y, 6.5f, 0.2f, WALL_HEIGHT, 0.4f, "p2", LABYRINTH_2},
-        {3.3f, FLOOR_Y, 6.3f, 0.2f, WALL_HEIGHT, 0.25f, "p2", LABYRINTH_2},
-        {4.5f, FLOOR_Y, 5.0f, 0.2f, WALL_HEIGHT, 0.25f, "p2", LABYRINTH_2},
-        {2.2f, FLOOR_Y, 7.0f, 0.3f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {7.0f, FLOOR_Y, 4.0f, 0.2f, WALL_HEIGHT, 0.3f, "p2", LABYRINTH_2},
-        {6.5f, FLOOR_Y, 6.8f, 0.2f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {6.4f, FLOOR_Y, 4.0f, 0.1f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {4.5f, FLOOR_Y, 2.0f, 0.2f, WALL_HEIGHT, 0.2f, "p2", LABYRINTH_2},
-
-        {0.0f, FLOOR_Y, 7.0f, 0.2f, WALL_HEIGHT, 0.1f, "p2", LABYRINTH_2},
-        {0.0f, FLOOR_Y, 5.5f, 0.6f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {0.0f, FLOOR_Y, 4.0f, 0.2f, WALL_HEIGHT, 0.4f, "p2", LABYRINTH_2},
-        {0.0f, FLOOR_Y, 5.5f, 0.6f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2},
-        {0.0f, FLOOR_Y, 7.0f, 0.2f, WALL_HEIGHT, 0.1f, "p2", LABYRINTH_2},
-
-        {6.4f, FLOOR_Y, 0.0f, 0.2f, WALL_HEIGHT, 0.5f, "p2", LABYRINTH_2},
-        {7.0f, FLOOR_Y, 0.0f, 0.2f, WALL_HEIGHT, 0.2f, "p22", LABYRINTH_2}};
-
-    std::vector<std::tuple<float, float, float, float, float, float, std::string, int>> centerWalls = {
-        {0.0f, FLOOR_Y, 1.0f, 0.4f, WALL_HEIGHT, 0.3f, "p3", LABYRINTH_3},
-        {2.1f, FLOOR_Y, -0.2f, 0.3f, WALL_HEIGHT, 0.2f, "p33", LABYRINTH_3},
-        {-2.1f, FLOOR_Y, -0.2f, 0.3f, WALL_HEIGHT, 0.2f, "p33", LABYRINTH_3},
-        {1.5f, FLOOR_Y, -1.1f, 0.125f, WALL_HEIGHT, 0.3f, "p3", LABYRINTH_3},
-        {-1.5f, FLOOR_Y, -1.1f, 0.125f, WALL_HEIGHT, 0.3f, "p3", LABYRINTH_3}};
-
-    auto addMirroredWalls = [&](float tx, float ty, float tz, float sx, float sy, float sz,
-                                const std::string &texture, int labyrinth)
-    {
-        walls.push_back(createWall(tx, ty, tz, sx, sy, sz, texture, labyrinth));
-
-        if (tx != 0)
-            walls.push_back(createWall(-tx, ty, tz, sx, sy, sz, texture, labyrinth));
-        if (tz != 0)
-            walls.push_back(createWall(tx, ty, -tz, sx, sy, sz, texture, labyrinth));
-        if (tx != 0 && tz != 0)
-            walls.push_back(createWall(-tx, ty, -tz, sx, sy, sz, texture, labyrinth));
-    };
-
-    auto addCenterWalls = [&](float tx, float ty, float tz, float sx, float sy, float sz,
-                              const std::string &texture, int labyrinth)
-    {
-        walls.push_back(createWall(tx, ty, tz, sx, sy, sz, texture, labyrinth));
-    };
+    PROFILE_FUNCTION();
+    const int MAX_SLIDES = 3;
+    const float SKIN = 1e-4f; // Folga mantida entre a esfera e a parede
 
-    for (const auto &[tx, ty, tz, sx, sy, sz, texture, labyrinth] : baseWalls)
+    std::vector<int> &nearby = g_WallGrid.nearby;
+    for (int slide = 0; slide < MAX_SLIDES; ++slide)
     {
-        if (tx <= MAX_X && tx >= MIN_X && tz <= MAX_Z && tz >= MIN_Z)
+        float length = glm::length(displacement);
+        if (length <= SKIN)
+            break;
+
+        // Broadphase: paredes que tocam a esfera que envolve todo o trajeto
+        nearby.clear();
+        FindWallsTouching(g_WallGrid, Sphere{s.center + 0.5f * displacement, s.radius + 0.5f * length}, nearby);
+
+        float first_toi = 1.0f;
+        glm::vec3 first_normal(0.0f);
+        bool hit = false;
+        for (int i : nearby)
         {
-            addMirroredWalls(tx, ty, tz, sx, sy, sz, texture, labyrinth);
+            float toi;
+            glm::vec3 normal;
+            if (sweepSphereToAABB(s, displacement, g_WallGrid.boxes[i], toi, normal) && toi <= first_toi)
+            {
+                // Empates (cantos internos) combinam as normais
+                first_normal = (hit && toi == first_toi) ? first_normal + normal : normal;
+                first_toi = toi;
+                hit = true;
+            }
         }
-    }
 
-    for (const auto &[tx, ty, tz, sx, sy, sz, texture, labyrinth] : centerWalls)
-    {
-        if (tx <= MAX_X && tx >= MIN_X && tz <= MAX_Z && tz >= MIN_Z)
+        if (!hit)
         {
-            addCenterWalls(tx, ty, tz, sx, sy, sz, texture, labyrinth);
+            s.center += displacement;
+            break;
         }
-    }
 
-    return walls;
+        float advance = std::max(0.0f, first_toi - SKIN / length);
+        s.center += displacement * advance;
+
+        glm::vec3 remaining = displacement * (1.0f - advance);
+        float normal_length = glm::length(first_normal);
+        if (normal_length < 1e-6f)
+            break; // Presa entre paredes opostas
+        first_normal /= normal_length;
+        displacement = remaining - first_normal * std::min(0.0f, glm::dot(remaining, first_normal));
+    }
+    return s.center;
 }
 
-void checkWallsCollision(std::vector<Wall> &walls, Sphere pacman_sphere, std::vector<glm::vec4> &all_collision_directions)
+// Pacotes de desenho das paredes [begin, end), com a AABB de colisão como
+// volume para o teste contra o frustum.
+void BuildWallPackets(const WallTable &walls, const Frustum &frustum, RenderPacketList &list, int begin, int end)
 {
-    for (Wall &wall : walls)
+    for (int i = begin; i < end; ++i)
     {
-        wall.render();
-        // Teste de colisão com paredes do labirinto
-        glm::vec4 collision_direction = checkSphereToAABBCollisionDirection(wall.wall_bbox, pacman_sphere);
-        if (norm(collision_direction) > 0)
-        {
-            all_collision_directions.push_back(collision_direction);
-        }
+        list.packets[i] = {walls.model[i], walls.render.object_type[i], walls.render.mesh[i]};
+        list.visible[i] = FrustumContainsAABB(frustum, walls.bounds[i]);
     }
 }
@@ -0,0 +1,192 @@
+#pragma once
+
+// Controle do ritmo dos quadros ("frame pacing"). Três modos:
+//  - VSYNC: glfwSwapInterval(1); o ritmo é dado pela taxa do monitor.
+//  - UNCAPPED: glfwSwapInterval(0) e nenhuma espera; usado para medições.
+//  - CAPPED: glfwSwapInterval(0) e um limite fixo de quadros por segundo.
+//    A espera é híbrida: dormimos até pouco antes do prazo (sem ocupar um
+//    núcleo) e terminamos com uma espera ativa curta, mais precisa que o
+//    escalonador do sistema operacional.
+// O intervalo entre quadros é guardado em um anel e resumido em percentis.
+
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <external/GLFW/glfw3.h>
+
+#include "utils/profiler.hpp"
+
+enum class FramePacerMode
+{
+    VSYNC,
+    UNCAPPED,
+    CAPPED
+};
+
+const char *FramePacerModeName(FramePacerMode mode)
+{
+    switch (mode)
+    {
+    case FramePacerMode::VSYNC:
+        return "vsync";
+    case FramePacerMode::UNCAPPED:
+        return "uncapped";
+    default:
+        return "capped";
+    }
+}
+
+// Número de intervalos guardados para o cálculo dos percentis.
+const int FRAME_PACER_HISTORY = 1024;
+
+// Margem de espera ativa no modo CAPPED. O "sleep" do sistema operacional
+// costuma acordar com atraso de algumas centenas de microssegundos.
+const double FRAME_PACER_SPIN_SECONDS = 0.0015;
+
+struct FrameIntervalStats
+{
+    int count = 0;
+    float mean_ms = 0.0f;
+    float p50_ms = 0.0f;
+    float p95_ms = 0.0f;
+    float p99_ms = 0.0f;
+    float max_ms = 0.0f;
+};
+
+struct FramePacer
+{
+    typedef std::chrono::steady_clock Clock;
+
+    GLFWwindow *window = NULL;
+    FramePacerMode mode = FramePacerMode::VSYNC;
+    double cap_fps = 60.0;
+
+    Clock::time_point next_deadline;
+    Clock::time_point last_frame;
+    bool has_last_frame = false;
+
+    float intervals_ms[FRAME_PACER_HISTORY] = {0};
+    int interval_count = 0;
+    int interval_next = 0;
+};
+
+FramePacer g_FramePacer;
+
+static void ResetFramePacerHistory(FramePacer &pacer)
+{
+    pacer.interval_count = 0;
+    pacer.interval_next = 0;
+    pacer.has_last_frame = false;
+}
+
+// Resume os intervalos registrados desde a última troca de modo.
+FrameIntervalStats ComputeFrameIntervalStats()
+{
+    const FramePacer &pacer = g_FramePacer;
+    FrameIntervalStats stats;
+    if (pacer.interval_count == 0)
+        return stats;
+
+    std::vector<float> sorted(pacer.intervals_ms, pacer.intervals_ms + pacer.interval_count);
+    std::sort(sorted.begin(), sorted.end());
+
+    float sum = 0.0f;
+    for (float ms : sorted)
+        sum += ms;
+
+    int n = (int)sorted.size();
+    stats.count = n;
+    stats.mean_ms = sum / n;
+    stats.p50_ms = sorted[(n - 1) * 50 / 100];
+    stats.p95_ms = sorted[(n - 1) * 95 / 100];
+    stats.p99_ms = sorted[(n - 1) * 99 / 100];
+    stats.max_ms = sorted[n - 1];
+    return stats;
+}
+
+void PrintFrameIntervalStats()
+{
+    FrameIntervalStats stats = ComputeFrameIntervalStats();
+    if (stats.count == 0)
+        return;
+
+    fprintf(stdout, "Frame pacing [%s]: %d quadros, média %.2f ms (%.1f FPS), p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, máx %.2f ms\n",
+            FramePacerModeName(g_FramePacer.mode), stats.count, stats.mean_ms, 1000.0f / stats.mean_ms,
+            stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms);
+    fflush(stdout);
+}
+
+void SetFramePacerMode(FramePacerMode mode)
+{
+    FramePacer &pacer = g_FramePacer;
+    pacer.mode = mode;
+    glfwSwapInterval(mode == FramePacerMode::VSYNC ? 1 : 0);
+    pacer.next_deadline = FramePacer::Clock::now();
+    ResetFramePacerHistory(pacer);
+}
+
+// Deve ser chamada com o contexto OpenGL da janela atual.
+void InitFramePacer(GLFWwindow *window, FramePacerMode mode)
+{
+    g_FramePacer.window = window;
+    SetFramePacerMode(mode);
+}
+
+// Tecla V: vsync -> uncapped -> capped -> vsync. As estatísticas do modo
+// anterior são impressas no terminal antes da troca.
+void CycleFramePacerMode()
+{
+    PrintFrameIntervalStats();
+
+    FramePacerMode next = FramePacerMode::VSYNC;
+    if (g_FramePacer.mode == FramePacerMode::VSYNC)
+        next = FramePacerMode::UNCAPPED;
+    else if (g_FramePacer.mode == FramePacerMode::UNCAPPED)
+        next = FramePacerMode::CAPPED;
+
+    SetFramePacerMode(next);
+    fprintf(stdout, "Frame pacing: modo %s\n", FramePacerModeName(next));
+    fflush(stdout);
+}
+
+// Chamada no início de cada quadro. No modo CAPPED espera até o prazo do
+// quadro; em todos os modos registra o intervalo desde o quadro anterior.
+void FramePacerBeginFrame()
+{
+    typedef FramePacer::Clock Clock;
+    FramePacer &pacer = g_FramePacer;
+
+    if (pacer.mode == FramePacerMode::CAPPED)
+    {
+        PROFILE_SCOPE("FramePacerWait");
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / pacer.cap_fps));
+        Clock::duration spin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FRAME_PACER_SPIN_SECONDS));
+
+        Clock::time_point now = Clock::now();
+        if (now + spin < pacer.next_deadline)
+            std::this_thread::sleep_for(pacer.next_deadline - spin - now);
+        while (Clock::now() < pacer.next_deadline)
+            std::this_thread::yield();
+
+        // Os prazos avançam de um período fixo, para não acumular erro. Se o
+        // quadro atrasou mais que um período, recomeçamos a partir de agora
+        // em vez de tentar "alcançar" com vários quadros seguidos.
+        pacer.next_deadline += period;
+        now = Clock::now();
+        if (pacer.next_deadline < now)
+            pacer.next_deadline = now + period;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (pacer.has_last_frame)
+    {
+        pacer.intervals_ms[pacer.interval_next] = std::chrono::duration<float, std::milli>(now - pacer.last_frame).count();
+        pacer.interval_next = (pacer.interval_next + 1) % FRAME_PACER_HISTORY;
+        pacer.interval_count = std::min(pacer.interval_count + 1, FRAME_PACER_HISTORY);
+    }
+    pacer.last_frame = now;
+    pacer.has_last_frame = true;
+}
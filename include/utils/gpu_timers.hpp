@@ -0,0 +1,140 @@
+#pragma once
+
+// Medição do tempo de GPU de cada etapa ("pass") da renderização com
+// queries GL_TIME_ELAPSED. Há um conjunto de queries por quadro em voo, em
+// anel: o resultado de um quadro só é lido GPU_TIMER_FRAMES quadros depois,
+// de modo que a CPU nunca espera pela GPU.
+//
+// Queries GL_TIME_ELAPSED não podem ser aninhadas; portanto as etapas são
+// sequenciais e o tempo total do quadro é a soma delas.
+
+#include <external/glad/glad.h>
+
+#include "utils/profiler.hpp"
+
+enum GpuPass
+{
+    GPU_PASS_SKY,
+    GPU_PASS_FLOOR,
+    GPU_PASS_MAZE,
+    GPU_PASS_PELLETS,
+    GPU_PASS_ACTORS,
+    GPU_PASS_HUD,
+    GPU_PASS_COUNT
+};
+
+const char *GpuPassName(int pass)
+{
+    static const char *names[GPU_PASS_COUNT] = {"sky", "floor", "maze", "pellets", "actors", "hud"};
+    return names[pass];
+}
+
+const int GPU_TIMER_FRAMES = 4;
+
+struct GpuTimers
+{
+    bool initialized = false;
+    GLuint queries[GPU_TIMER_FRAMES][GPU_PASS_COUNT];
+    bool issued[GPU_TIMER_FRAMES][GPU_PASS_COUNT];
+    int frame = 0;
+    int active_pass = -1;
+
+    // Últimos resultados lidos, em milissegundos
+    float pass_ms[GPU_PASS_COUNT] = {0};
+    float frame_ms = 0.0f;
+    int result_frame = -1; // Quadro a que os resultados acima se referem
+};
+
+GpuTimers g_GpuTimers;
+
+void InitGpuTimers()
+{
+    glGenQueries(GPU_TIMER_FRAMES * GPU_PASS_COUNT, &g_GpuTimers.queries[0][0]);
+    for (int f = 0; f < GPU_TIMER_FRAMES; ++f)
+        for (int p = 0; p < GPU_PASS_COUNT; ++p)
+            g_GpuTimers.issued[f][p] = false;
+    g_GpuTimers.initialized = true;
+}
+
+// Copia para pass_ms/frame_ms os resultados de um conjunto de queries.
+static void ReadGpuTimerSlot(GpuTimers &timers, int slot)
+{
+    float total = 0.0f;
+    for (int p = 0; p < GPU_PASS_COUNT; ++p)
+    {
+        float ms = 0.0f;
+        if (timers.issued[slot][p])
+        {
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(timers.queries[slot][p], GL_QUERY_RESULT, &elapsed_ns);
+            ms = elapsed_ns / 1.0e6f;
+        }
+        timers.pass_ms[p] = ms;
+        total += ms;
+        ProfileCounter("GPU (ms)", GpuPassName(p), ms);
+    }
+    timers.frame_ms = total;
+    timers.result_frame = timers.frame - GPU_TIMER_FRAMES;
+}
+
+// Início do quadro: lê os resultados do conjunto de queries que será
+// reutilizado neste quadro, se a GPU já os tiver produzido.
+void GpuTimersBeginFrame()
+{
+    GpuTimers &timers = g_GpuTimers;
+    if (!timers.initialized)
+        return;
+
+    int slot = timers.frame % GPU_TIMER_FRAMES;
+
+    // Se a GPU ainda não terminou aquele quadro, seus resultados são
+    // descartados pela reutilização das queries.
+    bool any_issued = false;
+    bool available = true;
+    for (int p = 0; p < GPU_PASS_COUNT && available; ++p)
+    {
+        if (!timers.issued[slot][p])
+            continue;
+        GLint query_available = 0;
+        glGetQueryObjectiv(timers.queries[slot][p], GL_QUERY_RESULT_AVAILABLE, &query_available);
+        available = query_available != 0;
+        any_issued = true;
+    }
+    if (any_issued && available)
+        ReadGpuTimerSlot(timers, slot);
+
+    for (int p = 0; p < GPU_PASS_COUNT; ++p)
+        timers.issued[slot][p] = false;
+}
+
+void BeginGpuPass(GpuPass pass)
+{
+    GpuTimers &timers = g_GpuTimers;
+    if (!timers.initialized || timers.active_pass >= 0)
+        return;
+
+    int slot = timers.frame % GPU_TIMER_FRAMES;
+    glBeginQuery(GL_TIME_ELAPSED, timers.queries[slot][pass]);
+    timers.issued[slot][pass] = true;
+    timers.active_pass = pass;
+}
+
+void EndGpuPass()
+{
+    GpuTimers &timers = g_GpuTimers;
+    if (timers.active_pass < 0)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    timers.active_pass = -1;
+}
+
+// Fim do quadro: o próximo quadro usa o próximo conjunto de queries.
+void GpuTimersEndFrame()
+{
+    GpuTimers &timers = g_GpuTimers;
+    if (!timers.initialized)
+        return;
+
+    timers.frame += 1;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Hash FNV-1a de 64 bits, sem dependências de OpenGL: usado pela chave do
+// cache de shaders (shader_utils.hpp) e pelo resumo do estado da simulação
+// (simulation.hpp). Veja https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
+
+#include <cstddef>
+#include <cstdint>
+
+// Continua o hash "hash" com os bytes [data, data + size); encadeie chamadas
+// passando o resultado da anterior.
+uint64_t HashBytes(const void *data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
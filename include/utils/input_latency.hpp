@@ -0,0 +1,164 @@
+#pragma once
+
+// Latência entre a entrada do usuário e a apresentação do quadro.
+//
+// O loop principal lê a entrada (glfwPollEvents) no início do quadro, antes
+// de amostrar a câmera e mover o Pac-Man, de modo que uma tecla pressionada
+// já afeta o quadro que está sendo montado.
+//
+// Com vsync, glfwSwapBuffers() pode liberar a CPU bem antes do próximo
+// "vblank", e a entrada lida logo em seguida envelhece até a apresentação.
+// No modo "esperar antes de renderizar" (tecla L) dormimos parte desse tempo
+// livre antes de ler a entrada, deixando apenas o tempo estimado de trabalho
+// do quadro (média móvel) mais uma margem.
+//
+// Para verificar o ganho, o intervalo entre a leitura da entrada e a
+// apresentação é medido nos quadros em que uma tecla foi pressionada.
+
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <external/glad/glad.h>
+#include <external/GLFW/glfw3.h>
+
+#include "utils/frame_pacer.hpp"
+
+// Margem de segurança, em segundos, para não perder o "vblank".
+const double INPUT_LATENCY_WAIT_MARGIN = 0.002;
+
+// Número de medições acumuladas antes de imprimir um resumo.
+const int INPUT_LATENCY_REPORT_EVERY = 20;
+
+struct InputLatency
+{
+    typedef std::chrono::steady_clock Clock;
+
+    bool wait_before_render = false;
+    double refresh_period = 1.0 / 60.0; // Período do monitor, em segundos
+    double work_estimate = 0.0;         // Média móvel de leitura -> fim da renderização
+
+    Clock::time_point last_present;
+    Clock::time_point poll_time;
+    bool has_present = false;
+    bool key_pressed = false; // Uma tecla foi pressionada neste quadro
+
+    int sample_count = 0;
+    double sample_sum_ms = 0.0;
+    double sample_max_ms = 0.0;
+};
+
+InputLatency g_InputLatency;
+
+// Deve ser chamada depois da criação da janela.
+void InitInputLatency()
+{
+    GLFWmonitor *monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode *video_mode = monitor ? glfwGetVideoMode(monitor) : NULL;
+    if (video_mode != NULL && video_mode->refreshRate > 0)
+        g_InputLatency.refresh_period = 1.0 / video_mode->refreshRate;
+}
+
+static void PrintInputLatencyReport()
+{
+    InputLatency &latency = g_InputLatency;
+    if (latency.sample_count == 0)
+        return;
+
+    fprintf(stdout, "Latência entrada -> apresentação [%s]: média %.2f ms, máx %.2f ms (%d teclas)\n",
+            latency.wait_before_render ? "esperar antes de renderizar" : "padrão",
+            latency.sample_sum_ms / latency.sample_count, latency.sample_max_ms, latency.sample_count);
+    fflush(stdout);
+
+    latency.sample_count = 0;
+    latency.sample_sum_ms = 0.0;
+    latency.sample_max_ms = 0.0;
+}
+
+// Tecla L: liga/desliga o modo "esperar antes de renderizar".
+void ToggleWaitBeforeRender()
+{
+    PrintInputLatencyReport();
+    g_InputLatency.wait_before_render = !g_InputLatency.wait_before_render;
+    g_InputLatency.has_present = false;
+    fprintf(stdout, "Esperar antes de renderizar: %s\n", g_InputLatency.wait_before_render ? "ligado" : "desligado");
+    fflush(stdout);
+}
+
+// Chamada pelo KeyCallback() a cada tecla pressionada.
+void NoteKeyPressed()
+{
+    g_InputLatency.key_pressed = true;
+}
+
+// A espera só faz sentido com vsync: sem um "vblank" para mirar, o modo
+// "esperar antes de renderizar" fica desligado, inclusive os glFinish().
+bool InputLatencyWaitActive()
+{
+    return g_InputLatency.wait_before_render && g_FramePacer.mode == FramePacerMode::VSYNC;
+}
+
+// Lê a entrada do usuário. No modo "esperar antes de renderizar" (somente com
+// vsync) dormimos antes, até o último instante que ainda permite terminar o
+// quadro antes do próximo "vblank".
+void PollInput()
+{
+    PROFILE_FUNCTION();
+    typedef InputLatency::Clock Clock;
+    InputLatency &latency = g_InputLatency;
+
+    if (InputLatencyWaitActive() && latency.has_present)
+    {
+        double slack = latency.refresh_period - latency.work_estimate - INPUT_LATENCY_WAIT_MARGIN;
+        Clock::time_point wake = latency.last_present + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(slack));
+        if (slack > 0.0 && wake > Clock::now())
+            std::this_thread::sleep_until(wake);
+    }
+
+    latency.key_pressed = false;
+    latency.poll_time = Clock::now();
+    glfwPollEvents();
+}
+
+// Chamada logo antes de glfwSwapBuffers(). O tempo de trabalho do quadro é
+// medido até aqui, sem incluir a espera pelo "vblank" dentro da troca de
+// buffers (que, somada, faria a estimativa crescer até o período inteiro).
+// glFinish() só é usada quando a medição é necessária.
+void MarkFrameRendered()
+{
+    typedef InputLatency::Clock Clock;
+    InputLatency &latency = g_InputLatency;
+
+    if (!InputLatencyWaitActive() && !latency.key_pressed)
+        return;
+
+    glFinish();
+    double work = std::chrono::duration<double>(Clock::now() - latency.poll_time).count();
+    latency.work_estimate = latency.work_estimate == 0.0 ? work : 0.9 * latency.work_estimate + 0.1 * work;
+}
+
+// Chamada logo após glfwSwapBuffers(); glFinish() garante que o quadro foi
+// de fato entregue.
+void MarkFramePresented()
+{
+    typedef InputLatency::Clock Clock;
+    InputLatency &latency = g_InputLatency;
+
+    if (!InputLatencyWaitActive() && !latency.key_pressed)
+        return;
+
+    glFinish();
+    latency.last_present = Clock::now();
+    latency.has_present = true;
+
+    if (latency.key_pressed)
+    {
+        double ms = std::chrono::duration<double, std::milli>(latency.last_present - latency.poll_time).count();
+        latency.sample_count += 1;
+        latency.sample_sum_ms += ms;
+        latency.sample_max_ms = std::max(latency.sample_max_ms, ms);
+        if (latency.sample_count >= INPUT_LATENCY_REPORT_EVERY)
+            PrintInputLatencyReport();
+    }
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+// Sistema de jobs com roubo de trabalho ("work stealing").
+//
+// Cada thread (a principal e as trabalhadoras) tem a sua fila dupla de jobs
+// prontos: a dona empilha e retira do fim (o job mais recente, ainda quente
+// na cache) e as outras, quando ficam sem trabalho, roubam do início (o job
+// mais antigo, em geral o maior). Um job pode depender de outros de um mesmo
+// JobGraph; ele só entra numa fila quando todos terminaram. Quem espera um
+// grafo (RunJobGraph(), ParallelFor()) executa jobs enquanto espera, então
+// jobs podem criar e esperar outros grafos sem travar as threads.
+//
+// Cada job executado vira uma zona do profiler com o nome do job, na linha
+// da thread que o executou.
+
+// Headers específicos de C++
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+#include "utils/profiler.hpp"
+
+struct JobGraph;
+
+struct Job
+{
+    const char *name;             // Nome da zona no profiler
+    std::function<void()> work;
+    std::atomic<int> pending{0};  // Dependências que ainda não terminaram
+    std::vector<Job *> dependents; // Jobs que esperam por este
+    JobGraph *graph = NULL;
+};
+
+// Conjunto de jobs e dependências executado de uma vez. std::deque mantém o
+// endereço dos jobs enquanto outros são acrescentados.
+struct JobGraph
+{
+    std::deque<Job> jobs;
+    std::atomic<int> remaining{0}; // Jobs ainda não concluídos
+};
+
+struct JobQueue
+{
+    std::mutex mutex;
+    std::deque<Job *> jobs;
+};
+
+struct JobSystem
+{
+    std::vector<std::unique_ptr<JobQueue>> queues; // queues[0] é a da thread principal
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0}; // Jobs prontos em alguma fila
+    std::atomic<int> sleeping{0};
+    std::atomic<bool> quit{false};
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+
+    // Saídas por std::exit() não passam por ShutdownJobSystem(); threads
+    // ainda ativas na destruição encerrariam o programa com std::terminate().
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            quit = true;
+            wake.notify_all();
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+};
+
+JobSystem g_JobSystem;
+
+// Índice da fila da thread atual; as threads que não pertencem ao sistema
+// usam a fila da principal.
+thread_local int t_JobQueueIndex = 0;
+
+int JobWorkerCount()
+{
+    return (int)g_JobSystem.workers.size();
+}
+
+static void PushJob(Job *job)
+{
+    JobSystem &system = g_JobSystem;
+    JobQueue &queue = *system.queues[t_JobQueueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    system.queued.fetch_add(1, std::memory_order_release);
+    if (system.sleeping.load(std::memory_order_acquire) > 0)
+    {
+        std::lock_guard<std::mutex> lock(system.sleep_mutex);
+        system.wake.notify_one();
+    }
+}
+
+// Retira o job mais recente da própria fila ou, se ela estiver vazia, rouba
+// o mais antigo da fila de outra thread.
+static Job *TakeJob()
+{
+    JobSystem &system = g_JobSystem;
+    if (system.queued.load(std::memory_order_acquire) == 0)
+        return NULL;
+
+    int count = (int)system.queues.size();
+    for (int i = 0; i < count; ++i)
+    {
+        int index = (t_JobQueueIndex + i) % count;
+        JobQueue &queue = *system.queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            continue;
+
+        Job *job;
+        if (i == 0)
+        {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        system.queued.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+    return NULL;
+}
+
+static void ExecuteJob(Job *job)
+{
+    {
+        ProfileScope scope(job->name);
+        job->work();
+    }
+    for (Job *dependent : job->dependents)
+    {
+        if (dependent->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            PushJob(dependent);
+    }
+    job->graph->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+static void JobWorkerMain(int index)
+{
+    t_JobQueueIndex = index;
+    JobSystem &system = g_JobSystem;
+    while (!system.quit.load(std::memory_order_acquire))
+    {
+        if (Job *job = TakeJob())
+        {
+            ExecuteJob(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(system.sleep_mutex);
+        system.sleeping.fetch_add(1, std::memory_order_acq_rel);
+        system.wake.wait(lock, [&system]()
+                         { return system.quit.load() || system.queued.load() > 0; });
+        system.sleeping.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+// Cria as threads trabalhadoras. Com "worker_count" negativo, uma para cada
+// núcleo além do da thread principal; com 0, todos os jobs rodam na thread
+// que espera o grafo.
+void InitJobSystem(int worker_count = -1)
+{
+    JobSystem &system = g_JobSystem;
+    if (worker_count < 0)
+        worker_count = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+
+    system.quit = false;
+    system.queues.clear();
+    for (int i = 0; i <= worker_count; ++i)
+        system.queues.emplace_back(new JobQueue());
+    for (int i = 1; i <= worker_count; ++i)
+        system.workers.emplace_back(JobWorkerMain, i);
+}
+
+void ShutdownJobSystem()
+{
+    JobSystem &system = g_JobSystem;
+    {
+        std::lock_guard<std::mutex> lock(system.sleep_mutex);
+        system.quit = true;
+        system.wake.notify_all();
+    }
+    for (std::thread &worker : system.workers)
+        worker.join();
+    system.workers.clear();
+}
+
+Job *AddJob(JobGraph &graph, const char *name, std::function<void()> work)
+{
+    graph.jobs.emplace_back();
+    Job &job = graph.jobs.back();
+    job.name = name;
+    job.work = std::move(work);
+    job.graph = &graph;
+    return &job;
+}
+
+// "job" só começa depois que "prerequisite" terminar.
+void AddJobDependency(Job *job, Job *prerequisite)
+{
+    prerequisite->dependents.push_back(job);
+    job->pending.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Enfileira os jobs sem dependências e executa jobs (deste ou de outros
+// grafos) até que todos os do grafo terminem.
+void RunJobGraph(JobGraph &graph)
+{
+    if (g_JobSystem.queues.empty())
+        InitJobSystem(0);
+
+    // As raízes são separadas antes de enfileirar a primeira: depois disso,
+    // um job já concluído pode zerar as dependências de outro, que seria
+    // enfileirado duas vezes.
+    std::vector<Job *> roots;
+    for (Job &job : graph.jobs)
+    {
+        if (job.pending.load(std::memory_order_relaxed) == 0)
+            roots.push_back(&job);
+    }
+
+    graph.remaining.store((int)graph.jobs.size(), std::memory_order_release);
+    for (Job *job : roots)
+        PushJob(job);
+
+    while (graph.remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (Job *job = TakeJob())
+            ExecuteJob(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+// Executa body(begin, end) sobre [0, count) em trechos de até "grain"
+// elementos, distribuídos entre as threads. Trechos menores que isso não
+// compensam o custo de criar jobs e rodam direto na thread atual.
+void ParallelFor(const char *name, int count, int grain, const std::function<void(int, int)> &body)
+{
+    if (count <= 0)
+        return;
+    if (count <= grain || JobWorkerCount() == 0)
+    {
+        ProfileScope scope(name);
+        body(0, count);
+        return;
+    }
+
+    JobGraph graph;
+    for (int begin = 0; begin < count; begin += grain)
+    {
+        int end = std::min(count, begin + grain);
+        AddJob(graph, name, [&body, begin, end]()
+               { body(begin, end); });
+    }
+    RunJobGraph(graph);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+// Profiler de CPU por zonas. Uma zona é marcada com PROFILE_SCOPE("nome")
+// (ou PROFILE_FUNCTION()) e dura até o fim do bloco onde foi declarada.
+// Cada thread grava suas zonas em um anel próprio (thread_local), sem
+// travas; o anel guarda os eventos mais recentes.
+//
+// Com a gravação desligada, cada marcador custa apenas a leitura de uma
+// variável atômica. Definindo PACMAN_PROFILER_DISABLED na compilação, os
+// marcadores desaparecem por completo.
+//
+// DumpChromeTrace() escreve os eventos dos últimos segundos no formato
+// "trace_event" do Chrome (abra em chrome://tracing ou https://ui.perfetto.dev).
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+// Eventos guardados por thread. A 60 FPS, com cerca de 20 zonas por quadro,
+// cobre bem mais que PROFILER_DUMP_SECONDS.
+const int PROFILER_RING_SIZE = 1 << 16;
+
+// Janela de tempo exportada por DumpChromeTrace().
+const double PROFILER_DUMP_SECONDS = 10.0;
+
+enum class ProfileEventType : uint8_t
+{
+    ZONE,
+    COUNTER
+};
+
+struct ProfileEvent
+{
+    const char *name; // Deve ser uma string estática
+    const char *arg;  // Nome da série, para contadores
+    int64_t start_ns;
+    int64_t duration_ns;
+    double value;
+    ProfileEventType type;
+};
+
+struct ProfileThreadBuffer
+{
+    int thread_id;
+    std::atomic<uint64_t> head{0}; // Total de eventos já gravados
+    ProfileEvent events[PROFILER_RING_SIZE];
+};
+
+std::atomic<bool> g_ProfilerEnabled(false);
+std::mutex g_ProfilerBuffersMutex;
+std::vector<std::unique_ptr<ProfileThreadBuffer>> g_ProfilerBuffers;
+thread_local ProfileThreadBuffer *t_ProfilerBuffer = NULL;
+
+int64_t ProfilerNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// O anel da thread é criado no primeiro evento e nunca é liberado, para que
+// os eventos de threads já encerradas continuem disponíveis para exportação.
+static ProfileThreadBuffer *ProfilerThreadBuffer()
+{
+    if (t_ProfilerBuffer == NULL)
+    {
+        std::lock_guard<std::mutex> lock(g_ProfilerBuffersMutex);
+        g_ProfilerBuffers.emplace_back(new ProfileThreadBuffer());
+        t_ProfilerBuffer = g_ProfilerBuffers.back().get();
+        t_ProfilerBuffer->thread_id = (int)g_ProfilerBuffers.size();
+    }
+    return t_ProfilerBuffer;
+}
+
+static void ProfilerRecord(const ProfileEvent &event)
+{
+    ProfileThreadBuffer *buffer = ProfilerThreadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % PROFILER_RING_SIZE] = event;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+// Registra o valor de uma série (ex.: tempo de GPU de uma etapa). Séries com
+// o mesmo "name" aparecem empilhadas no mesmo gráfico.
+void ProfileCounter(const char *name, const char *arg, double value)
+{
+    if (!g_ProfilerEnabled.load(std::memory_order_relaxed))
+        return;
+    ProfilerRecord({name, arg, ProfilerNow(), 0, value, ProfileEventType::COUNTER});
+}
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name)
+    {
+        if (!g_ProfilerEnabled.load(std::memory_order_relaxed))
+        {
+            name_ = NULL;
+            start_ns_ = 0;
+            return;
+        }
+        name_ = name;
+        start_ns_ = ProfilerNow();
+    }
+
+    ~ProfileScope()
+    {
+        if (name_ != NULL)
+            ProfilerRecord({name_, NULL, start_ns_, ProfilerNow() - start_ns_, 0.0, ProfileEventType::ZONE});
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name_;
+    int64_t start_ns_;
+};
+
+#ifndef PACMAN_PROFILER_DISABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
+
+// Escreve em "filename" os eventos dos últimos PROFILER_DUMP_SECONDS
+// segundos. Eventos sendo gravados durante a exportação podem ser perdidos.
+bool DumpChromeTrace(const char *filename)
+{
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+
+    int64_t now_ns = ProfilerNow();
+    int64_t first_ns = now_ns - (int64_t)(PROFILER_DUMP_SECONDS * 1e9);
+    size_t written = 0;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pacman\"}}");
+
+    std::lock_guard<std::mutex> lock(g_ProfilerBuffersMutex);
+    for (const std::unique_ptr<ProfileThreadBuffer> &buffer : g_ProfilerBuffers)
+    {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(head, PROFILER_RING_SIZE);
+        for (uint64_t i = head - count; i < head; ++i)
+        {
+            const ProfileEvent &event = buffer->events[i % PROFILER_RING_SIZE];
+            if (event.start_ns < first_ns)
+                continue;
+
+            double ts_us = (event.start_ns - first_ns) / 1000.0;
+            if (event.type == ProfileEventType::ZONE)
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        event.name, buffer->thread_id, ts_us, event.duration_ns / 1000.0);
+            else
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"%s\":%.4f}}",
+                        event.name, ts_us, event.arg, event.value);
+            written += 1;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    fprintf(stdout, "Trace salvo em \"%s\" (%zu eventos).\n", filename, written);
+    fflush(stdout);
+    return true;
+}
+
+// Tecla T: liga a gravação ou, se já estiver ligada, exporta o trace e a
+// desliga.
+void ToggleProfilerCapture()
+{
+    static int dump_count = 0;
+
+    if (!g_ProfilerEnabled.load())
+    {
+        g_ProfilerEnabled = true;
+        fprintf(stdout, "Profiler: gravando (tecla T para salvar).\n");
+        fflush(stdout);
+        return;
+    }
+
+    g_ProfilerEnabled = false;
+    char filename[64];
+    snprintf(filename, sizeof(filename), "pacman_trace_%d.json", dump_count++);
+    DumpChromeTrace(filename);
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+// Resolução dinâmica. A cena é renderizada em um framebuffer fora da tela
+// (FBO) com uma fração "scale" da resolução da janela e depois ampliada para
+// a janela. A fração é ajustada a cada quadro a partir do tempo de GPU medido
+// pelas "timer queries" de gpu_timers.hpp, de forma a manter o quadro dentro
+// de um orçamento de tempo (ex.: 16.6 ms para 60 Hz). Em máquinas fracas ou
+// com rasterização em software (llvmpipe) o jogo perde nitidez, mas não perde
+// quadros.
+
+#include <cmath>
+#include <algorithm>
+
+#include <external/glad/glad.h>
+
+#include "globals/globals.hpp"
+#include "utils/gpu_timers.hpp"
+
+struct DynamicResolution
+{
+    bool enabled = true;
+    float target_ms = 16.6f; // Orçamento de tempo de GPU por quadro
+    float min_scale = 0.5f;
+    float max_scale = 1.0f;
+    float scale = 1.0f;
+    float gpu_ms = 0.0f; // Último tempo de GPU medido
+
+    // O FBO tem sempre o tamanho da janela; a cena ocupa somente o canto
+    // inferior esquerdo (render_width x render_height). Assim, mudar a escala
+    // não exige realocar texturas.
+    GLuint framebuffer = 0;
+    GLuint color_texture = 0;
+    GLuint depth_renderbuffer = 0;
+    GLuint texture_unit = 0; // Unidade só da cor do FBO: as dos outros objetos não são tocadas
+    int window_width = 0;
+    int window_height = 0;
+    int allocated_width = 0;
+    int allocated_height = 0;
+    int render_width = 0;
+    int render_height = 0;
+
+    int measured_frame = -1; // Último quadro de g_GpuTimers considerado
+};
+
+DynamicResolution g_DynamicResolution;
+
+// Chamada por FramebufferSizeCallback(); o FBO é realocado no próximo quadro.
+void ResizeDynamicResolution(int width, int height)
+{
+    g_DynamicResolution.window_width = width;
+    g_DynamicResolution.window_height = height;
+}
+
+static void AllocateDynamicResolutionTargets(DynamicResolution &dr)
+{
+    if (dr.framebuffer == 0)
+    {
+        glGenFramebuffers(1, &dr.framebuffer);
+        glGenTextures(1, &dr.color_texture);
+        glGenRenderbuffers(1, &dr.depth_renderbuffer);
+        dr.texture_unit = g_NumLoadedTextures++;
+    }
+
+    int width = std::max(dr.window_width, 1);
+    int height = std::max(dr.window_height, 1);
+
+    // A textura fica ligada à sua própria unidade; ligá-la e desligá-la na
+    // unidade ativa apagaria a textura de outro objeto (placar, fonte).
+    glActiveTexture(GL_TEXTURE0 + dr.texture_unit);
+    glBindTexture(GL_TEXTURE_2D, dr.color_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, dr.depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, dr.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dr.color_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, dr.depth_renderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "WARNING: Offscreen framebuffer incomplete; dynamic resolution disabled.\n");
+        dr.enabled = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // O tamanho pedido, não o limitado acima: com a janela minimizada (0 x 0)
+    // não realocamos a cada quadro.
+    dr.allocated_width = dr.window_width;
+    dr.allocated_height = dr.window_height;
+}
+
+// Ajusta a escala sempre que g_GpuTimers tiver um resultado novo. Como o
+// número de pixels cresce com o quadrado da escala, corrigimos a escala pela
+// raiz da razão entre o orçamento e o tempo medido. Uma faixa morta entre 85%
+// e 100% do orçamento evita oscilações.
+static void UpdateDynamicResolutionScale(DynamicResolution &dr)
+{
+    if (g_GpuTimers.result_frame == dr.measured_frame)
+        return;
+    dr.measured_frame = g_GpuTimers.result_frame;
+    dr.gpu_ms = g_GpuTimers.frame_ms;
+
+    if (dr.gpu_ms <= 0.0f)
+        return;
+    if (dr.gpu_ms > dr.target_ms || dr.gpu_ms < 0.85f * dr.target_ms)
+    {
+        float wanted = dr.scale * std::sqrt(0.925f * dr.target_ms / dr.gpu_ms);
+        // Limitamos o passo por quadro para que a mudança não seja perceptível.
+        wanted = std::min(std::max(wanted, dr.scale - 0.05f), dr.scale + 0.05f);
+        dr.scale = std::min(std::max(wanted, dr.min_scale), dr.max_scale);
+    }
+}
+
+// Início do quadro: a cena passa a ser desenhada no FBO, na resolução atual.
+void BeginDynamicResolutionFrame()
+{
+    DynamicResolution &dr = g_DynamicResolution;
+
+    if (!dr.enabled)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, dr.window_width, dr.window_height);
+        return;
+    }
+
+    if (dr.allocated_width != dr.window_width || dr.allocated_height != dr.window_height)
+        AllocateDynamicResolutionTargets(dr);
+
+    UpdateDynamicResolutionScale(dr);
+
+    dr.render_width = std::max(1, (int)(dr.window_width * dr.scale));
+    dr.render_height = std::max(1, (int)(dr.window_height * dr.scale));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, dr.framebuffer);
+    glViewport(0, 0, dr.render_width, dr.render_height);
+}
+
+// Fim do quadro: amplia a imagem para a janela.
+void EndDynamicResolutionFrame()
+{
+    DynamicResolution &dr = g_DynamicResolution;
+    if (!dr.enabled)
+        return;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, dr.framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, dr.render_width, dr.render_height,
+                      0, 0, dr.window_width, dr.window_height,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, dr.window_width, dr.window_height);
+}
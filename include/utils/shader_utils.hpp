@@ -12,6 +12,7 @@
 // #include <vector>
 // #include <limits>
 // #include <fstream>
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
@@ -20,14 +21,12 @@
 
 #include "external/stb_image.h"
 #include "globals/globals.hpp"
+#include "utils/hash.hpp"
 
-// Função auxilar, utilizada pelas duas funções acima. Carrega código de GPU de
-// um arquivo GLSL e faz sua compilação.
-void LoadShader(const char *filename, GLuint shader_id)
+// Lê o código-fonte GLSL do arquivo indicado por "filename" e o retorna como
+// uma string. Encerra o programa caso o arquivo não possa ser aberto.
+std::string ReadShaderSource(const char *filename)
 {
-    // Lemos o arquivo de texto indicado pela variável "filename"
-    // e colocamos seu conteúdo em memória, apontado pela variável
-    // "shader_string".
     std::ifstream file;
     try
     {
@@ -41,16 +40,29 @@ void LoadShader(const char *filename, GLuint shader_id)
     }
     std::stringstream shader;
     shader << file.rdbuf();
-    std::string str = shader.str();
-    const GLchar *shader_string = str.c_str();
-    const GLint shader_string_length = static_cast<GLint>(str.length());
+    return shader.str();
+}
+
+// Envia o código GLSL contido em "source" para o shader "shader_id" e pede a
+// sua compilação. Não consulta o resultado: o driver pode compilar em segundo
+// plano até que CheckShaderCompilation() seja chamada.
+void SubmitShaderSource(const std::string &source, GLuint shader_id)
+{
+    const GLchar *shader_string = source.c_str();
+    const GLint shader_string_length = static_cast<GLint>(source.length());
 
     // Define o código do shader GLSL, contido na string "shader_string"
     glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
 
     // Compila o código do shader GLSL (em tempo de execução)
     glCompileShader(shader_id);
+}
 
+// Verifica o resultado da compilação de "shader_id", imprimindo no terminal
+// qualquer erro ou "warning". O nome do arquivo é utilizado somente nas
+// mensagens. Retorna true se a compilação foi bem sucedida.
+bool CheckShaderCompilation(const char *filename, GLuint shader_id)
+{
     // Verificamos se ocorreu algum erro ou "warning" durante a compilação
     GLint compiled_ok;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled_ok);
@@ -92,6 +104,22 @@ void LoadShader(const char *filename, GLuint shader_id)
 
     // A chamada "delete" em C++ é equivalente ao "free()" do C
     delete[] log;
+
+    return compiled_ok == GL_TRUE;
+}
+
+// Compila o código GLSL contido em "source" no shader "shader_id".
+void CompileShaderSource(const char *filename, const std::string &source, GLuint shader_id)
+{
+    SubmitShaderSource(source, shader_id);
+    CheckShaderCompilation(filename, shader_id);
+}
+
+// Função auxilar, utilizada pelas duas funções abaixo. Carrega código de GPU de
+// um arquivo GLSL e faz sua compilação.
+void LoadShader(const char *filename, GLuint shader_id)
+{
+    CompileShaderSource(filename, ReadShaderSource(filename), shader_id);
 }
 
 // Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
@@ -122,20 +150,153 @@ GLuint LoadShader_Fragment(const char *filename)
     return fragment_shader_id;
 }
 
-// Esta função cria um programa de GPU, o qual contém obrigatoriamente um
-// Vertex Shader e um Fragment Shader.
-GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
+// Cache de binários de programas de GPU. glGetProgramBinary() faz parte do
+// OpenGL 4.1 (ou da extensão GL_ARB_get_program_binary), e portanto não é
+// carregada pela GLAD 3.3: buscamos os ponteiros manualmente com a GLFW.
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void(APIENTRYP PFN_GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFN_ProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void(APIENTRYP PFN_ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+struct ProgramBinaryApi
 {
-    // Criamos um identificador (ID) para este programa de GPU
+    bool available = false;
+    PFN_GetProgramBinary GetProgramBinary = NULL;
+    PFN_ProgramBinary ProgramBinary = NULL;
+    PFN_ProgramParameteri ProgramParameteri = NULL;
+    std::string driver; // Vendor, renderer e versão: binários só valem para o mesmo driver
+};
+
+ProgramBinaryApi g_ProgramBinary;
+
+// Identificador gravado no início de cada arquivo de cache.
+const uint32_t PROGRAM_CACHE_MAGIC = 0x42474346; // "FCGB"
+
+// Deve ser chamada após gladLoadGLLoader(). Se o driver não suportar binários
+// de programa, o cache fica desativado e os shaders são sempre compilados.
+void InitProgramBinaryCache()
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = (major > 4 || (major == 4 && minor >= 1)) || glfwExtensionSupported("GL_ARB_get_program_binary");
+
+    if (supported)
+    {
+        g_ProgramBinary.GetProgramBinary = (PFN_GetProgramBinary)glfwGetProcAddress("glGetProgramBinary");
+        g_ProgramBinary.ProgramBinary = (PFN_ProgramBinary)glfwGetProcAddress("glProgramBinary");
+        g_ProgramBinary.ProgramParameteri = (PFN_ProgramParameteri)glfwGetProcAddress("glProgramParameteri");
+
+        GLint num_formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+
+        g_ProgramBinary.available = g_ProgramBinary.GetProgramBinary && g_ProgramBinary.ProgramBinary &&
+                                    g_ProgramBinary.ProgramParameteri && num_formats > 0;
+    }
+
+    g_ProgramBinary.driver = std::string((const char *)glGetString(GL_VENDOR)) + "|" +
+                             (const char *)glGetString(GL_RENDERER) + "|" +
+                             (const char *)glGetString(GL_VERSION);
+
+    printf("Cache de binarios de shaders: %s\n", g_ProgramBinary.available ? "ativado" : "indisponivel");
+}
+
+// Chave do cache: código-fonte dos dois shaders e a string do driver. Qualquer
+// alteração nos arquivos GLSL ou atualização de driver gera uma nova chave.
+uint64_t ProgramCacheKey(const std::string &vertex_source, const std::string &fragment_source)
+{
+    uint64_t hash = HashBytes(vertex_source.data(), vertex_source.size());
+    hash = HashBytes("\0", 1, hash);
+    hash = HashBytes(fragment_source.data(), fragment_source.size(), hash);
+    hash = HashBytes("\0", 1, hash);
+    return HashBytes(g_ProgramBinary.driver.data(), g_ProgramBinary.driver.size(), hash);
+}
+
+// Os binários são gravados no diretório do executável (ex.: bin/Linux/).
+std::string ProgramCachePath(uint64_t key)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "program_%016llx.glbin", (unsigned long long)key);
+    return path;
+}
+
+bool IsProgramLinked(GLuint program_id)
+{
+    GLint linked_ok = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
+    return linked_ok == GL_TRUE;
+}
+
+// Tenta carregar um programa do cache. Retorna 0 se o arquivo não existir ou
+// se o driver rejeitar o binário (nesse caso, o chamador recompila).
+GLuint LoadProgramBinary(uint64_t key)
+{
+    if (!g_ProgramBinary.available)
+        return 0;
+
+    std::ifstream file(ProgramCachePath(key), std::ios::binary);
+    if (!file)
+        return 0;
+
+    uint32_t header[3]; // magic, formato, tamanho
+    uint64_t stored_key = 0;
+    if (!file.read((char *)header, sizeof(header)) || !file.read((char *)&stored_key, sizeof(stored_key)))
+        return 0;
+    if (header[0] != PROGRAM_CACHE_MAGIC || stored_key != key || header[2] == 0)
+        return 0;
+
+    std::vector<char> binary(header[2]);
+    if (!file.read(binary.data(), binary.size()))
+        return 0;
+
     GLuint program_id = glCreateProgram();
+    g_ProgramBinary.ProgramBinary(program_id, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
 
-    // Definição dos dois shaders GLSL que devem ser executados pelo programa
-    glAttachShader(program_id, vertex_shader_id);
-    glAttachShader(program_id, fragment_shader_id);
+    if (!IsProgramLinked(program_id))
+    {
+        glDeleteProgram(program_id);
+        return 0;
+    }
 
-    // Linkagem dos shaders acima ao programa
-    glLinkProgram(program_id);
+    return program_id;
+}
+
+void SaveProgramBinary(GLuint program_id, uint64_t key)
+{
+    if (!g_ProgramBinary.available || !IsProgramLinked(program_id))
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    g_ProgramBinary.GetProgramBinary(program_id, length, &length, &format, binary.data());
+
+    std::ofstream file(ProgramCachePath(key), std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        fprintf(stderr, "WARNING: Cannot write shader cache \"%s\".\n", ProgramCachePath(key).c_str());
+        return;
+    }
 
+    uint32_t header[3] = {PROGRAM_CACHE_MAGIC, (uint32_t)format, (uint32_t)length};
+    file.write((const char *)header, sizeof(header));
+    file.write((const char *)&key, sizeof(key));
+    file.write(binary.data(), length);
+}
+
+// Verifica o resultado da linkagem de "program_id", imprimindo no terminal
+// qualquer erro. Retorna true se a linkagem foi bem sucedida.
+bool CheckProgramLink(GLuint program_id)
+{
     // Verificamos se ocorreu algum erro durante a linkagem
     GLint linked_ok = GL_FALSE;
     glGetProgramiv(program_id, GL_LINK_STATUS, &linked_ok);
@@ -165,6 +326,29 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
         fprintf(stderr, "%s", output.c_str());
     }
 
+    return linked_ok == GL_TRUE;
+}
+
+// Esta função cria um programa de GPU, o qual contém obrigatoriamente um
+// Vertex Shader e um Fragment Shader.
+GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
+{
+    // Criamos um identificador (ID) para este programa de GPU
+    GLuint program_id = glCreateProgram();
+
+    // Definição dos dois shaders GLSL que devem ser executados pelo programa
+    glAttachShader(program_id, vertex_shader_id);
+    glAttachShader(program_id, fragment_shader_id);
+
+    // Pedimos ao driver que mantenha o binário do programa disponível para
+    // glGetProgramBinary(). Veja SaveProgramBinary().
+    if (g_ProgramBinary.available)
+        g_ProgramBinary.ProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // Linkagem dos shaders acima ao programa
+    glLinkProgram(program_id);
+    CheckProgramLink(program_id);
+
     // Os "Shader Objects" podem ser marcados para deleção após serem linkados
     glDeleteShader(vertex_shader_id);
     glDeleteShader(fragment_shader_id);
@@ -173,6 +357,68 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
     return program_id;
 }
 
+// Carrega um programa de GPU a partir de dois arquivos GLSL. Se existir um
+// binário em cache para exatamente este código-fonte e este driver, o
+// programa é criado com glProgramBinary() sem compilar nada; caso contrário os
+// shaders são compilados, linkados e o binário resultante é salvo no cache.
+GLuint LoadGpuProgram(const char *vertex_filename, const char *fragment_filename)
+{
+    std::string vertex_source = ReadShaderSource(vertex_filename);
+    std::string fragment_source = ReadShaderSource(fragment_filename);
+    uint64_t key = ProgramCacheKey(vertex_source, fragment_source);
+
+    GLuint program_id = LoadProgramBinary(key);
+    if (program_id != 0)
+        return program_id;
+
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    CompileShaderSource(vertex_filename, vertex_source, vertex_shader_id);
+    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+    CompileShaderSource(fragment_filename, fragment_source, fragment_shader_id);
+
+    program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+    SaveProgramBinary(program_id, key);
+
+    return program_id;
+}
+
+// Busca as localizações das variáveis "uniform" do programa principal e
+// associa cada sampler à sua unidade de textura. Deve ser chamada sempre que
+// g_GpuProgramID for substituído.
+void SetupGpuProgram(GLuint program_id)
+{
+    // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
+    // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
+    // (GPU)! Veja arquivo "shader_vertex.glsl" e "shader_fragment.glsl".
+    g_model_uniform = glGetUniformLocation(program_id, "model");           // Variável da matriz "model"
+    g_view_uniform = glGetUniformLocation(program_id, "view");             // Variável da matriz "view" em shader_vertex.glsl
+    g_projection_uniform = glGetUniformLocation(program_id, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
+    g_object_id_uniform = glGetUniformLocation(program_id, "object_id");   // Variável "object_id" em shader_fragment.glsl
+    g_bbox_min_uniform = glGetUniformLocation(program_id, "bbox_min");
+    g_bbox_max_uniform = glGetUniformLocation(program_id, "bbox_max");
+
+    // Estados do jogo, enviados a cada quadro (veja main()). Alterá-los não
+    // exige recompilar os shaders.
+    g_is_free_cam_on_uniform = glGetUniformLocation(program_id, "isFreeCamOn");
+    g_game_over_uniform = glGetUniformLocation(program_id, "gameOver");
+    g_won_game_uniform = glGetUniformLocation(program_id, "wonGame");
+
+    // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "FloorTexture"), 1);
+    glUniform1i(glGetUniformLocation(program_id, "LabyrinthTexture"), 2);
+    glUniform1i(glGetUniformLocation(program_id, "PacmanTexture"), 3);
+    glUniform1i(glGetUniformLocation(program_id, "LittleBallTexture"), 4);
+    glUniform1i(glGetUniformLocation(program_id, "CherryTexture"), 5);
+    glUniform1i(glGetUniformLocation(program_id, "NumbersTexture"), 6);
+    glUniform1i(glGetUniformLocation(program_id, "GhostTexture"), 7);
+    glUniform1i(glGetUniformLocation(program_id, "GhostTexture2"), 8);
+    glUniform1i(glGetUniformLocation(program_id, "GhostTexture3"), 9);
+    glUniform1i(glGetUniformLocation(program_id, "LabyrinthTextureRed"), 10);
+    glUniform1i(glGetUniformLocation(program_id, "LabyrinthTextureGreen"), 11);
+    glUseProgram(0);
+}
+
 // Função que carrega os shaders de vértices e de fragmentos que serão
 // utilizados para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
 //
@@ -196,51 +442,13 @@ void LoadShadersFromFiles()
     //       |
     //       o-- shader_fragment.glsl
     //
-    GLuint vertex_shader_id = LoadShader_Vertex("../../resources/shaders/shader_vertex.glsl");
-    GLuint fragment_shader_id = LoadShader_Fragment("../../resources/shaders/shader_fragment.glsl");
+    GLuint program_id = LoadGpuProgram("../../resources/shaders/shader_vertex.glsl",
+                                       "../../resources/shaders/shader_fragment.glsl");
 
     // Deletamos o programa de GPU anterior, caso ele exista.
     if (g_GpuProgramID != 0)
         glDeleteProgram(g_GpuProgramID);
 
-    // Criamos um programa de GPU utilizando os shaders carregados acima.
-    g_GpuProgramID = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
-
-    // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
-    // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
-    // (GPU)! Veja arquivo "shader_vertex.glsl" e "shader_fragment.glsl".
-    g_model_uniform = glGetUniformLocation(g_GpuProgramID, "model");           // Variável da matriz "model"
-    g_view_uniform = glGetUniformLocation(g_GpuProgramID, "view");             // Variável da matriz "view" em shader_vertex.glsl
-    g_projection_uniform = glGetUniformLocation(g_GpuProgramID, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
-    g_object_id_uniform = glGetUniformLocation(g_GpuProgramID, "object_id");   // Variável "object_id" em shader_fragment.glsl
-    g_bbox_min_uniform = glGetUniformLocation(g_GpuProgramID, "bbox_min");
-    g_bbox_max_uniform = glGetUniformLocation(g_GpuProgramID, "bbox_max");
-
-    // Variáveis em "shader_fragment.glsl" para acesso das imagens de textura
-    glUseProgram(g_GpuProgramID);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "SkyBoxTexture"), 0);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "FloorTexture"), 1);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "LabyrinthTexture"), 2);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "PacmanTexture"), 3);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "LittleBallTexture"), 4);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "CherryTexture"), 5);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "NumbersTexture"), 6);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "GhostTexture"), 7);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "GhostTexture2"), 8);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "GhostTexture3"), 9);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "LabyrinthTextureRed"), 10);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "LabyrinthTextureGreen"), 11);
-
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "isFreeCamOn"), isFreeCamOn);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "gameOver"), game_over);
-    glUniform1i(glGetUniformLocation(g_GpuProgramID, "wonGame"), won_game);
-
-    glUseProgram(0);
-}
-
-void ReloadShaders()
-{
-    LoadShadersFromFiles();
-    fprintf(stdout, "Shaders recarregados!\n");
-    fflush(stdout);
+    g_GpuProgramID = program_id;
+    SetupGpuProgram(g_GpuProgramID);
 }
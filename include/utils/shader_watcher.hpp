@@ -0,0 +1,325 @@
+#pragma once
+
+// Recarregamento "a quente" dos shaders. Uma thread observa o diretório
+// resources/shaders/ (inotify, no Linux) e lê do disco os arquivos GLSL que
+// forem alterados. A thread principal, que é dona do contexto OpenGL, apenas
+// dispara a compilação e verifica, um quadro de cada vez, se ela terminou.
+// Quando a linkagem é bem sucedida o novo programa substitui o antigo; se
+// houver erro, o programa antigo continua sendo utilizado.
+
+// Headers específicos de C++
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <external/glad/glad.h>
+#include <external/GLFW/glfw3.h>
+
+#include "utils/shader_utils.hpp"
+#include "utils/profiler.hpp"
+
+// GL_KHR_parallel_shader_compile (ou a versão ARB) permite que o driver
+// compile em várias threads próprias e que consultemos o término sem bloquear.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void(APIENTRYP PFN_MaxShaderCompilerThreads)(GLuint count);
+
+const char *SHADERS_DIRECTORY = "../../resources/shaders/";
+
+// Etapas de uma recompilação em andamento.
+enum class ShaderJobStage
+{
+    IDLE,
+    COMPILING,
+    LINKING
+};
+
+// Um programa de GPU registrado para recarregamento. "program_id" aponta para
+// a variável global que guarda o programa em uso (ex.: g_GpuProgramID) e
+// "setup" é chamada sobre o novo programa antes da troca.
+struct HotReloadProgram
+{
+    std::string vertex_path;
+    std::string fragment_path;
+    GLuint *program_id;
+    void (*setup)(GLuint program_id);
+
+    // Código-fonte lido pela thread observadora (protegido por g_HotReloadMutex)
+    bool has_pending_sources = false;
+    std::string pending_vertex_source;
+    std::string pending_fragment_source;
+
+    // Compilação em andamento (somente a thread principal acessa)
+    ShaderJobStage stage = ShaderJobStage::IDLE;
+    GLuint vertex_shader = 0;
+    GLuint fragment_shader = 0;
+    GLuint program = 0;
+    uint64_t key = 0;
+    int frames_waited = 0;
+};
+
+std::vector<HotReloadProgram> g_HotReloadPrograms;
+std::mutex g_HotReloadMutex;
+std::thread g_ShaderWatcherThread;
+std::atomic<bool> g_ShaderWatcherRunning(false);
+std::atomic<bool> g_ShaderReloadRequested(false);
+bool g_ParallelShaderCompile = false;
+
+// Registra um programa para recarregamento. Deve ser chamada antes de
+// StartShaderWatcher().
+void RegisterHotReloadProgram(const char *vertex_path, const char *fragment_path, GLuint *program_id, void (*setup)(GLuint))
+{
+    HotReloadProgram entry;
+    entry.vertex_path = vertex_path;
+    entry.fragment_path = fragment_path;
+    entry.program_id = program_id;
+    entry.setup = setup;
+    g_HotReloadPrograms.push_back(entry);
+}
+
+// Pede o recarregamento de todos os programas (tecla R). A leitura dos
+// arquivos também é feita pela thread observadora.
+void RequestShaderReload()
+{
+    g_ShaderReloadRequested = true;
+}
+
+static std::string FileNameOf(const std::string &path)
+{
+    size_t i = path.find_last_of("/");
+    return (i == std::string::npos) ? path : path.substr(i + 1);
+}
+
+// Lê do disco as fontes dos programas que usam o arquivo "changed_file" (ou
+// de todos, se "changed_file" for vazio) e as deixa disponíveis para a thread
+// principal.
+static void ReadChangedPrograms(const std::string &changed_file)
+{
+    PROFILE_FUNCTION();
+    for (size_t i = 0; i < g_HotReloadPrograms.size(); ++i)
+    {
+        const HotReloadProgram &entry = g_HotReloadPrograms[i];
+        if (!changed_file.empty() && FileNameOf(entry.vertex_path) != changed_file && FileNameOf(entry.fragment_path) != changed_file)
+            continue;
+
+        std::ifstream vertex_file(entry.vertex_path);
+        std::ifstream fragment_file(entry.fragment_path);
+        if (!vertex_file || !fragment_file)
+            continue;
+
+        std::stringstream vertex_source, fragment_source;
+        vertex_source << vertex_file.rdbuf();
+        fragment_source << fragment_file.rdbuf();
+
+        std::lock_guard<std::mutex> lock(g_HotReloadMutex);
+        g_HotReloadPrograms[i].pending_vertex_source = vertex_source.str();
+        g_HotReloadPrograms[i].pending_fragment_source = fragment_source.str();
+        g_HotReloadPrograms[i].has_pending_sources = true;
+    }
+}
+
+static void ShaderWatcherLoop()
+{
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK);
+    if (fd >= 0 && inotify_add_watch(fd, SHADERS_DIRECTORY, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        fprintf(stderr, "WARNING: Cannot watch \"%s\"; use R to reload shaders.\n", SHADERS_DIRECTORY);
+        close(fd);
+        fd = -1;
+    }
+#endif
+
+    while (g_ShaderWatcherRunning)
+    {
+        if (g_ShaderReloadRequested.exchange(false))
+            ReadChangedPrograms("");
+
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            // Acordamos a cada 100 ms para atender à tecla R e ao encerramento.
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 100) <= 0)
+                continue;
+
+            alignas(struct inotify_event) char buffer[4096];
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const struct inotify_event *event = (const struct inotify_event *)(buffer + offset);
+                if (event->len > 0)
+                {
+                    std::string name(event->name);
+                    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".glsl") == 0)
+                        ReadChangedPrograms(name);
+                }
+                offset += sizeof(struct inotify_event) + event->len;
+            }
+            continue;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+#endif
+}
+
+// Inicia a thread observadora. Deve ser chamada com o contexto OpenGL atual,
+// depois que todos os programas foram registrados.
+void StartShaderWatcher()
+{
+    PFN_MaxShaderCompilerThreads max_threads = NULL;
+    if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+        max_threads = (PFN_MaxShaderCompilerThreads)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+    else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+        max_threads = (PFN_MaxShaderCompilerThreads)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+
+    if (max_threads != NULL)
+    {
+        max_threads(0xFFFFFFFF); // Número de threads escolhido pelo driver
+        g_ParallelShaderCompile = true;
+    }
+
+    g_ShaderWatcherRunning = true;
+    g_ShaderWatcherThread = std::thread(ShaderWatcherLoop);
+}
+
+void StopShaderWatcher()
+{
+    g_ShaderWatcherRunning = false;
+    if (g_ShaderWatcherThread.joinable())
+        g_ShaderWatcherThread.join();
+}
+
+// Sem a extensão de compilação paralela não há como saber se o driver já
+// terminou; esperamos um quadro entre cada etapa para diluir o custo.
+static bool IsShaderJobReady(GLuint object, bool is_program, HotReloadProgram &entry)
+{
+    if (g_ParallelShaderCompile)
+    {
+        GLint done = GL_FALSE;
+        if (is_program)
+            glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &done);
+        else
+            glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+    return ++entry.frames_waited > 1;
+}
+
+static void CancelShaderJob(HotReloadProgram &entry)
+{
+    if (entry.vertex_shader != 0)
+        glDeleteShader(entry.vertex_shader);
+    if (entry.fragment_shader != 0)
+        glDeleteShader(entry.fragment_shader);
+    if (entry.program != 0)
+        glDeleteProgram(entry.program);
+
+    entry.vertex_shader = 0;
+    entry.fragment_shader = 0;
+    entry.program = 0;
+    entry.stage = ShaderJobStage::IDLE;
+}
+
+// Avança as recompilações pendentes. Chamada uma vez por quadro pela thread
+// principal; nunca espera pelo compilador.
+void UpdateShaderHotReload()
+{
+    for (HotReloadProgram &entry : g_HotReloadPrograms)
+    {
+        std::string vertex_source, fragment_source;
+        bool has_sources = false;
+        {
+            std::lock_guard<std::mutex> lock(g_HotReloadMutex);
+            if (entry.has_pending_sources)
+            {
+                vertex_source.swap(entry.pending_vertex_source);
+                fragment_source.swap(entry.pending_fragment_source);
+                entry.has_pending_sources = false;
+                has_sources = true;
+            }
+        }
+
+        // Uma nova versão dos arquivos descarta a compilação em andamento.
+        if (has_sources)
+        {
+            CancelShaderJob(entry);
+
+            entry.key = ProgramCacheKey(vertex_source, fragment_source);
+            entry.vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+            entry.fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+            SubmitShaderSource(vertex_source, entry.vertex_shader);
+            SubmitShaderSource(fragment_source, entry.fragment_shader);
+            entry.stage = ShaderJobStage::COMPILING;
+            entry.frames_waited = 0;
+            continue;
+        }
+
+        if (entry.stage == ShaderJobStage::COMPILING)
+        {
+            if (!IsShaderJobReady(entry.vertex_shader, false, entry) || !IsShaderJobReady(entry.fragment_shader, false, entry))
+                continue;
+
+            bool vertex_ok = CheckShaderCompilation(entry.vertex_path.c_str(), entry.vertex_shader);
+            bool fragment_ok = CheckShaderCompilation(entry.fragment_path.c_str(), entry.fragment_shader);
+            if (!vertex_ok || !fragment_ok)
+            {
+                fprintf(stderr, "Shaders mantidos: a versão anterior continua em uso.\n");
+                CancelShaderJob(entry);
+                continue;
+            }
+
+            entry.program = glCreateProgram();
+            glAttachShader(entry.program, entry.vertex_shader);
+            glAttachShader(entry.program, entry.fragment_shader);
+            if (g_ProgramBinary.available)
+                g_ProgramBinary.ProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(entry.program);
+
+            entry.stage = ShaderJobStage::LINKING;
+            entry.frames_waited = 0;
+        }
+        else if (entry.stage == ShaderJobStage::LINKING)
+        {
+            if (!IsShaderJobReady(entry.program, true, entry))
+                continue;
+
+            if (!CheckProgramLink(entry.program))
+            {
+                fprintf(stderr, "Shaders mantidos: a versão anterior continua em uso.\n");
+                CancelShaderJob(entry);
+                continue;
+            }
+
+            // Troca atômica do ponto de vista da renderização: o quadro atual
+            // passa a usar o novo programa por inteiro.
+            SaveProgramBinary(entry.program, entry.key);
+            entry.setup(entry.program);
+            glDeleteProgram(*entry.program_id);
+            *entry.program_id = entry.program;
+            entry.program = 0;
+            CancelShaderJob(entry);
+
+            fprintf(stdout, "Shaders recarregados!\n");
+            fflush(stdout);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+// Painel de estatísticas (tecla H): FPS, percentis do intervalo entre
+// quadros, chamadas de desenho, triângulos, tempos de CPU por etapa do loop
+// e tempos de GPU por etapa da renderização.
+//
+// Para não distorcer os números que mostra, o painel:
+//  - é desenhado depois da ampliação da resolução dinâmica, fora das etapas
+//    medidas por gpu_timers.hpp;
+//  - não entra na contagem de chamadas de desenho e triângulos;
+//  - tem seu tempo de CPU medido em uma etapa própria ("overlay");
+//  - só remonta o texto algumas vezes por segundo. Nos demais quadros o
+//    custo é uma única chamada de desenho com os vértices já na GPU.
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#include "utils/text_renderer.hpp"
+#include "utils/frame_pacer.hpp"
+#include "utils/gpu_timers.hpp"
+#include "utils/render_scale.hpp"
+#include "globals/globals.hpp"
+
+// Intervalo entre remontagens do texto, em segundos.
+const double STATS_OVERLAY_REFRESH = 0.25;
+
+enum CpuStage
+{
+    CPU_STAGE_INPUT,
+    CPU_STAGE_UPDATE,
+    CPU_STAGE_RENDER,
+    CPU_STAGE_OVERLAY,
+    CPU_STAGE_SWAP,
+    CPU_STAGE_COUNT
+};
+
+const char *CpuStageName(int stage)
+{
+    static const char *names[CPU_STAGE_COUNT] = {"input", "update", "render", "overlay", "swap"};
+    return names[stage];
+}
+
+struct StatsOverlay
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Tempos de CPU por etapa do loop (média móvel, em milissegundos)
+    float cpu_ms[CPU_STAGE_COUNT] = {0};
+    int open_stage = -1;
+    Clock::time_point stage_start;
+
+    // Contadores do último quadro completo
+    int draw_calls = 0;
+    long long triangles = 0;
+
+    Clock::time_point last_rebuild;
+    bool has_text = false;
+};
+
+StatsOverlay g_StatsOverlay;
+
+static void CloseCpuStage(StatsOverlay &overlay, StatsOverlay::Clock::time_point now)
+{
+    if (overlay.open_stage < 0)
+        return;
+
+    float ms = std::chrono::duration<float, std::milli>(now - overlay.stage_start).count();
+    float &average = overlay.cpu_ms[overlay.open_stage];
+    average = 0.9f * average + 0.1f * ms;
+    overlay.open_stage = -1;
+}
+
+// Encerra a etapa de CPU aberta (se houver) e inicia "stage".
+void BeginCpuStage(CpuStage stage)
+{
+    StatsOverlay::Clock::time_point now = StatsOverlay::Clock::now();
+    CloseCpuStage(g_StatsOverlay, now);
+    g_StatsOverlay.open_stage = stage;
+    g_StatsOverlay.stage_start = now;
+}
+
+void EndCpuStages()
+{
+    CloseCpuStage(g_StatsOverlay, StatsOverlay::Clock::now());
+}
+
+// Guarda os contadores do quadro anterior e os zera para o quadro atual.
+void StatsOverlayBeginFrame()
+{
+    g_StatsOverlay.draw_calls = g_FrameDrawCalls;
+    g_StatsOverlay.triangles = g_FrameTriangles;
+    g_FrameDrawCalls = 0;
+    g_FrameTriangles = 0;
+}
+
+static void RebuildStatsOverlayText(int screen_height)
+{
+    const StatsOverlay &overlay = g_StatsOverlay;
+    FrameIntervalStats frames = ComputeFrameIntervalStats();
+
+    char lines[8][96];
+    int line_count = 0;
+
+    snprintf(lines[line_count++], sizeof(lines[0]), "FPS %.1f (%.2f ms) %s",
+             frames.mean_ms > 0.0f ? 1000.0f / frames.mean_ms : 0.0f, frames.mean_ms, FramePacerModeName(g_FramePacer.mode));
+    snprintf(lines[line_count++], sizeof(lines[0]), "p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+             frames.p50_ms, frames.p95_ms, frames.p99_ms, frames.max_ms);
+    snprintf(lines[line_count++], sizeof(lines[0]), "draws %d  tris %lld  scale %.2f",
+             overlay.draw_calls, overlay.triangles, g_DynamicResolution.scale);
+    snprintf(lines[line_count++], sizeof(lines[0]), "CPU  %s %.2f  %s %.2f  %s %.2f",
+             CpuStageName(0), overlay.cpu_ms[0], CpuStageName(1), overlay.cpu_ms[1], CpuStageName(2), overlay.cpu_ms[2]);
+    snprintf(lines[line_count++], sizeof(lines[0]), "     %s %.2f  %s %.2f",
+             CpuStageName(3), overlay.cpu_ms[3], CpuStageName(4), overlay.cpu_ms[4]);
+    snprintf(lines[line_count++], sizeof(lines[0]), "GPU  %s %.2f  %s %.2f  %s %.2f",
+             GpuPassName(0), g_GpuTimers.pass_ms[0], GpuPassName(1), g_GpuTimers.pass_ms[1], GpuPassName(2), g_GpuTimers.pass_ms[2]);
+    snprintf(lines[line_count++], sizeof(lines[0]), "     %s %.2f  %s %.2f  %s %.2f",
+             GpuPassName(3), g_GpuTimers.pass_ms[3], GpuPassName(4), g_GpuTimers.pass_ms[4], GpuPassName(5), g_GpuTimers.pass_ms[5]);
+    snprintf(lines[line_count++], sizeof(lines[0]), "     total %.2f", g_GpuTimers.frame_ms);
+
+    size_t longest = 0;
+    for (int i = 0; i < line_count; ++i)
+        longest = std::max(longest, strlen(lines[i]));
+
+    const float margin = 8.0f;
+    const float padding = 6.0f;
+    float line_height = TextLineHeight();
+    float top = screen_height - margin;
+    float width = longest * TextCharWidth() + 2.0f * padding;
+    float height = line_count * line_height + 2.0f * padding;
+
+    TextBegin();
+    TextAddPanel(margin, top - height, margin + width, top, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+    float baseline = top - padding - dejavufont.ascender;
+    for (int i = 0; i < line_count; ++i)
+    {
+        TextAddString(margin + padding, baseline, lines[i], glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+        baseline -= line_height;
+    }
+    TextEnd();
+}
+
+// Desenha o painel sobre o framebuffer da janela, se estiver visível.
+void RenderStatsOverlay(int screen_width, int screen_height)
+{
+    BeginCpuStage(CPU_STAGE_OVERLAY);
+    if (!g_ShowInfoText)
+    {
+        g_StatsOverlay.has_text = false;
+        return;
+    }
+
+    StatsOverlay &overlay = g_StatsOverlay;
+    StatsOverlay::Clock::time_point now = StatsOverlay::Clock::now();
+    if (!overlay.has_text || std::chrono::duration<double>(now - overlay.last_rebuild).count() >= STATS_OVERLAY_REFRESH)
+    {
+        RebuildStatsOverlayText(screen_height);
+        overlay.last_rebuild = now;
+        overlay.has_text = true;
+    }
+
+    TextDraw(screen_width, screen_height);
+}
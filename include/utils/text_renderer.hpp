@@ -0,0 +1,197 @@
+#pragma once
+
+// Renderização de texto em lote com o atlas pré-rasterizado da fonte DejaVu
+// Sans Mono (external/dejavufont.h). O atlas é enviado para a GPU uma única
+// vez; o texto é montado na CPU como uma lista de quadriláteros (dois
+// triângulos por caractere) e desenhado com uma única chamada glDrawArrays.
+//
+// Uso: TextBegin(), TextAddPanel()/TextAddString() quantas vezes necessário,
+// TextEnd() para enviar os vértices, e TextDraw() a cada quadro. Se o texto
+// não mudou, basta chamar TextDraw(): os vértices continuam na GPU.
+
+#include <vector>
+
+#include <external/glad/glad.h>
+#include <external/dejavufont.h>
+
+#include "utils/shader_utils.hpp"
+#include "globals/globals.hpp"
+
+struct TextVertex
+{
+    float x, y; // Pixels da janela, origem no canto inferior esquerdo
+    float s, t; // Coordenadas no atlas
+    float r, g, b, a;
+};
+
+GLuint g_TextProgramID = 0;
+GLint g_text_screen_size_uniform;
+GLuint g_TextVertexArrayID = 0;
+GLuint g_TextVertexBufferID = 0;
+GLuint g_FontTextureID = 0;
+GLint g_FontTextureUnit = 0;
+
+// Glifos indexados pelo código ASCII; NULL para caracteres fora do atlas.
+const texture_glyph_t *g_FontGlyphs[128];
+// Centro da região sólida (cobertura 1.0) reservada pelo freetype-gl.
+float g_FontSolidS, g_FontSolidT;
+
+std::vector<TextVertex> g_TextVertices;
+size_t g_TextBufferCapacity = 0; // Em vértices
+GLsizei g_TextVertexCount = 0;
+
+void SetupTextProgram(GLuint program_id)
+{
+    g_text_screen_size_uniform = glGetUniformLocation(program_id, "screen_size");
+
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "FontAtlas"), g_FontTextureUnit);
+    glUseProgram(0);
+}
+
+// Deve ser chamada após LoadTexturesFromFiles(), pois ocupa a próxima unidade
+// de textura livre com o atlas.
+void LoadTextRenderer()
+{
+    for (int i = 0; i < 128; ++i)
+        g_FontGlyphs[i] = NULL;
+    for (size_t i = 0; i < dejavufont.glyphs_count; ++i)
+    {
+        const texture_glyph_t &glyph = dejavufont.glyphs[i];
+        if (glyph.codepoint < 128)
+            g_FontGlyphs[glyph.codepoint] = &glyph;
+        else if (glyph.codepoint == (uint32_t)-1)
+        {
+            g_FontSolidS = 0.5f * (glyph.s0 + glyph.s1);
+            g_FontSolidT = 0.5f * (glyph.t0 + glyph.t1);
+        }
+    }
+
+    g_FontTextureUnit = g_NumLoadedTextures++;
+    glGenTextures(1, &g_FontTextureID);
+    glActiveTexture(GL_TEXTURE0 + g_FontTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, g_FontTextureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, (GLsizei)dejavufont.tex_width, (GLsizei)dejavufont.tex_height, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, dejavufont.tex_data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // O texto é desenhado em pixels inteiros, sem escala: GL_NEAREST é exato.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    g_TextProgramID = LoadGpuProgram("../../resources/shaders/text_vertex.glsl",
+                                     "../../resources/shaders/text_fragment.glsl");
+    SetupTextProgram(g_TextProgramID);
+
+    glGenVertexArrays(1, &g_TextVertexArrayID);
+    glBindVertexArray(g_TextVertexArrayID);
+    glGenBuffers(1, &g_TextVertexBufferID);
+    glBindBuffer(GL_ARRAY_BUFFER, g_TextVertexBufferID);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)(4 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+// Altura de uma linha de texto, em pixels.
+float TextLineHeight()
+{
+    return dejavufont.height;
+}
+
+// Largura de um caractere, em pixels (a fonte é monoespaçada).
+float TextCharWidth()
+{
+    return g_FontGlyphs[' '] ? g_FontGlyphs[' ']->advance_x : dejavufont.size * 0.6f;
+}
+
+void TextBegin()
+{
+    g_TextVertices.clear();
+}
+
+static void TextAddQuad(float x0, float y0, float x1, float y1, float s0, float t0, float s1, float t1, const glm::vec4 &color)
+{
+    TextVertex v00 = {x0, y0, s0, t1, color.r, color.g, color.b, color.a};
+    TextVertex v10 = {x1, y0, s1, t1, color.r, color.g, color.b, color.a};
+    TextVertex v11 = {x1, y1, s1, t0, color.r, color.g, color.b, color.a};
+    TextVertex v01 = {x0, y1, s0, t0, color.r, color.g, color.b, color.a};
+
+    g_TextVertices.push_back(v00);
+    g_TextVertices.push_back(v10);
+    g_TextVertices.push_back(v11);
+    g_TextVertices.push_back(v00);
+    g_TextVertices.push_back(v11);
+    g_TextVertices.push_back(v01);
+}
+
+// Retângulo sólido (fundo do painel), desenhado na mesma chamada do texto.
+void TextAddPanel(float x0, float y0, float x1, float y1, const glm::vec4 &color)
+{
+    TextAddQuad(x0, y0, x1, y1, g_FontSolidS, g_FontSolidT, g_FontSolidS, g_FontSolidT, color);
+}
+
+// Adiciona "text" com a linha de base em (x, y). Retorna a posição x final.
+float TextAddString(float x, float y, const char *text, const glm::vec4 &color)
+{
+    for (const char *c = text; *c != '\0'; ++c)
+    {
+        const texture_glyph_t *glyph = ((unsigned char)*c < 128) ? g_FontGlyphs[(unsigned char)*c] : NULL;
+        if (glyph == NULL)
+            glyph = g_FontGlyphs['?'];
+        if (glyph == NULL)
+            continue;
+
+        if (glyph->width > 0 && glyph->height > 0)
+        {
+            float x0 = x + glyph->offset_x;
+            float y1 = y + glyph->offset_y;
+            TextAddQuad(x0, y1 - glyph->height, x0 + glyph->width, y1, glyph->s0, glyph->t0, glyph->s1, glyph->t1, color);
+        }
+        x += glyph->advance_x;
+    }
+    return x;
+}
+
+// Envia os vértices montados desde TextBegin() para a GPU.
+void TextEnd()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, g_TextVertexBufferID);
+    if (g_TextVertices.size() > g_TextBufferCapacity)
+        g_TextBufferCapacity = g_TextVertices.size() * 2;
+
+    // Realocar o buffer ("orphaning") evita que o driver espere a GPU terminar
+    // de ler os vértices anteriores.
+    glBufferData(GL_ARRAY_BUFFER, g_TextBufferCapacity * sizeof(TextVertex), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, g_TextVertices.size() * sizeof(TextVertex), g_TextVertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    g_TextVertexCount = (GLsizei)g_TextVertices.size();
+}
+
+// Desenha o último texto enviado por TextEnd() sobre o framebuffer atual.
+void TextDraw(int screen_width, int screen_height)
+{
+    if (g_TextVertexCount == 0)
+        return;
+
+    glUseProgram(g_TextProgramID);
+    glUniform2f(g_text_screen_size_uniform, (float)screen_width, (float)screen_height);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindVertexArray(g_TextVertexArrayID);
+    glDrawArrays(GL_TRIANGLES, 0, g_TextVertexCount);
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+}
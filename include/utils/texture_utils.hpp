@@ -17,9 +17,11 @@
 #include <algorithm>
 
 #include <external/glad/glad.h>
+#include <external/glm/glm.hpp>
 
 #include "external/stb_image.h"
 #include "globals/globals.hpp"
+#include "utils/profiler.hpp"
 
 // Função que carrega uma imagem para ser utilizada como textura
 void LoadTextureImage(const char *filename)
@@ -73,9 +75,141 @@ void LoadTextureImage(const char *filename)
     g_NumLoadedTextures += 1;
 }
 
+// Converte a imagem do céu em um cubemap. Cada texel de cada face recebe a
+// cor que o antigo Fragment Shader do skybox calculava para a mesma direção
+// (mapeamento plano por face do cubo, com a escala negativa aplicada ao
+// modelo), de modo que o resultado visual não muda.
+void LoadCubemapFromImage(const char *filename, int face_size)
+{
+    printf("Carregando cubemap \"%s\"... ", filename);
+
+    stbi_set_flip_vertically_on_load(true);
+    int width;
+    int height;
+    int channels;
+    unsigned char *data = stbi_load(filename, &width, &height, &channels, 3);
+
+    if (data == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open image file \"%s\".\n", filename);
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Reduzimos a imagem com um filtro de caixa até próximo do tamanho da
+    // face, para que a amostragem bilinear abaixo não gere serrilhado.
+    int factor = std::max(1, std::min(width, height) / face_size);
+    int src_width = width / factor;
+    int src_height = height / factor;
+    std::vector<float> src(src_width * src_height * 3, 0.0f);
+    for (int y = 0; y < src_height * factor; ++y)
+        for (int x = 0; x < src_width * factor; ++x)
+            for (int c = 0; c < 3; ++c)
+                src[((y / factor) * src_width + (x / factor)) * 3 + c] += data[(y * width + x) * 3 + c];
+    for (float &value : src)
+        value /= (float)(factor * factor);
+
+    stbi_image_free(data);
+
+    auto sample = [&](float u, float v, int c) -> float
+    {
+        float x = std::min(std::max(u * src_width - 0.5f, 0.0f), (float)(src_width - 1));
+        float y = std::min(std::max(v * src_height - 0.5f, 0.0f), (float)(src_height - 1));
+        int x0 = (int)x, y0 = (int)y;
+        int x1 = std::min(x0 + 1, src_width - 1), y1 = std::min(y0 + 1, src_height - 1);
+        float fx = x - x0, fy = y - y0;
+        float top = src[(y0 * src_width + x0) * 3 + c] * (1 - fx) + src[(y0 * src_width + x1) * 3 + c] * fx;
+        float bottom = src[(y1 * src_width + x0) * 3 + c] * (1 - fx) + src[(y1 * src_width + x1) * 3 + c] * fx;
+        return top * (1 - fy) + bottom * fy;
+    };
+
+    GLuint texture_id;
+    GLuint sampler_id;
+    glGenTextures(1, &texture_id);
+    glGenSamplers(1, &sampler_id);
+
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(sampler_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+    GLuint textureunit = g_NumLoadedTextures;
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
+
+    std::vector<unsigned char> face(face_size * face_size * 3);
+    for (int f = 0; f < 6; ++f)
+    {
+        for (int j = 0; j < face_size; ++j)
+        {
+            for (int i = 0; i < face_size; ++i)
+            {
+                // Direção correspondente ao texel (i,j) da face f, seguindo a
+                // tabela de seleção de faces da especificação OpenGL.
+                float sc = 2.0f * (i + 0.5f) / face_size - 1.0f;
+                float tc = 2.0f * (j + 0.5f) / face_size - 1.0f;
+                glm::vec3 dir;
+                switch (f)
+                {
+                case 0: dir = glm::vec3(1.0f, -tc, -sc); break;  // +X
+                case 1: dir = glm::vec3(-1.0f, -tc, sc); break;  // -X
+                case 2: dir = glm::vec3(sc, 1.0f, tc); break;    // +Y
+                case 3: dir = glm::vec3(sc, -1.0f, -tc); break;  // -Y
+                case 4: dir = glm::vec3(sc, -tc, 1.0f); break;   // +Z
+                default: dir = glm::vec3(-sc, -tc, -1.0f); break; // -Z
+                }
+
+                // O cubo do skybox era desenhado com escala negativa, então a
+                // posição no modelo é a direção global invertida.
+                glm::vec3 position_cube = -dir;
+                glm::vec3 abs_pos = glm::abs(position_cube);
+                float max_axis = std::max(std::max(abs_pos.x, abs_pos.y), abs_pos.z);
+                float U, V;
+                if (max_axis == abs_pos.x)
+                {
+                    U = (position_cube.x > 0) ? -position_cube.z : position_cube.z;
+                    V = position_cube.y;
+                }
+                else if (max_axis == abs_pos.y)
+                {
+                    U = position_cube.x;
+                    V = (position_cube.y > 0) ? -position_cube.z : position_cube.z;
+                }
+                else
+                {
+                    U = (position_cube.z > 0) ? position_cube.x : -position_cube.x;
+                    V = position_cube.y;
+                }
+                U = (U + 1.0f) / 2.0f;
+                V = (V + 1.0f) / 2.0f;
+
+                for (int c = 0; c < 3; ++c)
+                    face[(j * face_size + i) * 3 + c] = (unsigned char)(sample(U, V, c) + 0.5f);
+            }
+        }
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_SRGB8, face_size, face_size, 0, GL_RGB, GL_UNSIGNED_BYTE, face.data());
+    }
+
+    glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    glBindSampler(textureunit, sampler_id);
+
+    // Filtragem sem costuras visíveis entre as faces do cubemap
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    printf("OK (6x%dx%d).\n", face_size, face_size);
+
+    g_NumLoadedTextures += 1;
+}
+
 void LoadTexturesFromFiles()
 {
-    LoadTextureImage("../../resources/textures/skybox/walltexture.jpg");
+    PROFILE_FUNCTION();
+    LoadCubemapFromImage("../../resources/textures/skybox/walltexture.jpg", 1024);
     LoadTextureImage("../../resources/textures/skybox/floortexture.jpg");
     LoadTextureImage("../../resources/textures/labyrinth/blue.jpg");
     LoadTextureImage("../../resources/textures/pacman/pacmanColor.png");
@@ -87,4 +221,4 @@ void LoadTexturesFromFiles()
     LoadTextureImage("../../resources/textures/ghost/ghostTexture3.png");
     LoadTextureImage("../../resources/textures/labyrinth/red.jpg");
     LoadTextureImage("../../resources/textures/labyrinth/green.jpg");
-}
\ No newline at end of file
+}
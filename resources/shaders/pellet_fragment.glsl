@@ -0,0 +1,75 @@
+#version 330 core
+
+// Ray casting de uma esfera para os impostores das bolinhas. O raio parte da
+// câmera e passa pelo fragmento atual; a interseção com a esfera define a
+// normal, a iluminação e a profundidade escrita no Z-buffer.
+
+in vec3 position_view;
+flat in vec3 center_view;
+flat in float radius;
+flat in vec3 light_view;
+
+uniform mat4 projection;
+
+// A esfera original (sphere.obj) não possui coordenadas de textura, então a
+// cor difusa sempre foi a do texel (0,0) desta textura.
+uniform sampler2D LittleBallTexture;
+
+out vec4 color;
+
+void main()
+{
+    // Raio no sistema de coordenadas da câmera. Na projeção ortográfica todos
+    // os raios são paralelos ao eixo -Z.
+    vec3 ray_origin = vec3(0.0, 0.0, 0.0);
+    vec3 ray_direction = normalize(position_view);
+    if (projection[2][3] == 0.0)
+    {
+        ray_origin = vec3(position_view.xy, 0.0);
+        ray_direction = vec3(0.0, 0.0, -1.0);
+    }
+
+    // |o + t*d - c|² = r²  =>  t² + 2 b t + c = 0, com |d| = 1
+    vec3 oc = ray_origin - center_view;
+    float b = dot(oc, ray_direction);
+    float c = dot(oc, oc) - radius * radius;
+    float delta = b * b - c;
+    if (delta < 0.0)
+        discard;
+
+    float t = -b - sqrt(delta);
+    vec3 p = ray_origin + t * ray_direction;
+
+    // Profundidade do ponto de interseção, para que as bolinhas se cruzem
+    // corretamente com o restante da cena.
+    vec4 clip = projection * vec4(p, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+
+    // Mesmo modelo de iluminação que era avaliado por vértice (Gouraud):
+    // Lambert + Blinn-Phong, com a luz na origem do mundo.
+    vec3 n = (p - center_view) / radius;
+    vec3 v = normalize(-p);
+    vec3 l = normalize(light_view - p);
+    vec3 h = normalize(l + v);
+
+    float q = 50.0;
+
+    vec3 Ka = vec3(0.05, 0.05, 0.05);
+    vec3 Ks = vec3(0.8, 0.8, 0.8);
+    vec3 Ia = vec3(0.5, 0.5, 0.5);
+    vec3 I  = vec3(1.5, 1.5, 1.5);
+
+    vec3 Kd = texture(LittleBallTexture, vec2(0.0, 0.0)).rgb;
+
+    float lambert = max(0, dot(n, l));
+
+    vec3 lambert_diffuse_term = Kd * I * lambert;
+    vec3 ambient_term = Ka * Ia;
+    vec3 blinn_phong_specular_term = Ks * I * pow(max(0, dot(n, h)), q);
+
+    color.rgb = lambert_diffuse_term + ambient_term + blinn_phong_specular_term;
+    color.a = 1;
+
+    // Cor final com correção gamma, considerando monitor sRGB.
+    color.rgb = pow(color.rgb, vec3(1.0,1.0,1.0)/2.2);
+}
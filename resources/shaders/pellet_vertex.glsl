@@ -0,0 +1,57 @@
+#version 330 core
+
+// Impostores das bolinhas: cada bolinha é desenhada como um quadrado voltado
+// para a câmera (4 vértices), e a esfera é calculada analiticamente no
+// Fragment Shader. Veja RenderPellets() em "ball.hpp".
+
+// Canto do quadrado, em [-1,1]x[-1,1]
+layout (location = 0) in vec2 corner;
+
+// Atributo por instância: centro da bolinha (xyz) e raio (w)
+layout (location = 3) in vec4 pellet;
+
+// Matrizes computadas no código C++ e enviadas para a GPU
+uniform mat4 view;
+uniform mat4 projection;
+
+// Um bit por bolinha (1 = ainda não foi comida). Veja KillPellet() em "ball.hpp".
+uniform usamplerBuffer PelletAliveMask;
+
+// Atributos interpolados pelo rasterizador, todos no sistema de coordenadas
+// da câmera.
+out vec3 position_view;
+flat out vec3 center_view;
+flat out float radius;
+flat out vec3 light_view;
+
+void main()
+{
+    // Bolinhas já comidas viram um ponto fora do volume de visualização e são
+    // descartadas antes da rasterização.
+    uint word = texelFetch(PelletAliveMask, gl_InstanceID >> 5).r;
+    if ((word & (1u << uint(gl_InstanceID & 31))) == 0u)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    center_view = (view * vec4(pellet.xyz, 1.0)).xyz;
+    radius = pellet.w;
+
+    // A fonte de luz fica na origem do sistema de coordenadas global, assim
+    // como no cálculo de Gouraud feito anteriormente para as bolinhas.
+    light_view = (view * vec4(0.0, 0.0, 0.0, 1.0)).xyz;
+
+    // Na projeção perspectiva a silhueta da esfera é maior do que o raio no
+    // plano do centro: o cone tangente tem raio r*d/sqrt(d²-r²) nesse plano.
+    // Usamos uma margem de 10% para cobrir esferas fora do eixo óptico.
+    float half_size = radius;
+    if (projection[2][3] != 0.0)
+    {
+        float d = length(center_view);
+        half_size = 1.1 * radius * d / sqrt(max(d * d - radius * radius, 1e-6));
+    }
+
+    position_view = center_view + vec3(corner * half_size, 0.0);
+    gl_Position = projection * vec4(position_view, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+// A textura do placar já contém a iluminação e a correção gamma aplicadas
+// por "shader_fragment.glsl" quando os dígitos foram desenhados nela. O fundo
+// tem alpha 0 e é descartado.
+in vec2 texcoords;
+
+uniform sampler2D ScoreTexture;
+
+out vec4 color;
+
+void main()
+{
+    color = texture(ScoreTexture, texcoords);
+    if (color.a < 0.5)
+        discard;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// Placar: um único quadrilátero texturizado com a imagem dos dígitos,
+// gerada por UpdateScoreTexture() em "numbers.hpp". Os vértices (cantos do
+// quadrado [-1,1]x[-1,1]) são gerados a partir de gl_VertexID.
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec2 texcoords;
+
+void main()
+{
+    const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+    vec2 corner = corners[gl_VertexID];
+
+    texcoords = 0.5 * corner + 0.5;
+    gl_Position = projection * view * model * vec4(corner, 0.0, 1.0);
+}
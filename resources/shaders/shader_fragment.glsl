@@ -13,8 +13,6 @@ in vec4 position_model;
 // Coordenadas de textura obtidas do arquivo OBJ (se existirem!)
 in vec2 texcoords;
 
-in vec4 colorGouraud;
-
 // Matrizes computadas no código C++ e enviadas para a GPU
 uniform mat4 model;
 uniform mat4 view;
@@ -42,7 +40,6 @@ uniform vec4 bbox_min;
 uniform vec4 bbox_max;
 
 // Variáveis para acesso das imagens de textura
-uniform sampler2D SkyBoxTexture;
 uniform sampler2D FloorTexture;
 uniform sampler2D LabyrinthTexture;
 uniform sampler2D PacmanTexture;
@@ -130,11 +127,7 @@ void main()
     // Termo ambiente
     vec3 ambient_term = Ka * Ia; // termo ambiente
 
-    if ( object_id == SPHERE )
-    {
-        color = colorGouraud;     
-    }
-    else if ( object_id == PLANE )
+    if ( object_id == PLANE )
     {
         U = texcoords.x + 10.0f;
         V = texcoords.y + 10.0f;
@@ -145,47 +138,6 @@ void main()
         Kd = texture(FloorTexture, vec2(U,V)).rgb;
         color.rgb = Kd;
     }
-    else if ( object_id == BACKGROUND )
-    {
-        vec4 bbox_center = (bbox_min + bbox_max) / 2.0;
-
-        vec4 position_cube = position_model - bbox_center;
-
-        vec4 abs_pos = abs(position_cube);
-        float max_axis = max(max(abs_pos.x, abs_pos.y), abs_pos.z);
-
-        if (max_axis == abs_pos.x) {
-            if (position_cube.x > 0) {
-                U = -position_cube.z;
-                V = position_cube.y;
-            } else {
-                U = position_cube.z;
-                V = position_cube.y;
-            }
-        } else if (max_axis == abs_pos.y) {
-            if (position_cube.y > 0) {
-                U = position_cube.x;
-                V = -position_cube.z;
-            } else {
-                U = position_cube.x;
-                V = position_cube.z;
-            }
-        } else {
-            if (position_cube.z > 0) {
-                U = position_cube.x;
-                V = position_cube.y;    
-            } else {
-                U = -position_cube.x;
-                V = position_cube.y;
-            }
-        }
-
-        U = (U + 1.0) / 2.0;
-        V = (V + 1.0) / 2.0;
-
-        Kd = texture(SkyBoxTexture, vec2(U,V)).rgb;
-        color.rgb = Kd;
-    }
     else if ( object_id == LABYRINTH_2 || object_id == LABYRINTH_3 )
     {
         U = texcoords.x;
@@ -0,0 +1,45 @@
+#version 330 core
+
+in vec2 ndc;
+
+// Inversa de projection * view, para reconstruir o raio de cada pixel
+uniform mat4 inverse_view_projection;
+
+// Meia aresta do cubo do skybox, centrado na origem (farplane/4)
+uniform float sky_half_size;
+
+uniform samplerCube SkyBoxCubemap;
+
+out vec4 color;
+
+void main()
+{
+    // Pontos do pixel nos planos near e far, em coordenadas globais. Funciona
+    // tanto para projeção perspectiva quanto ortográfica.
+    vec4 near_point = inverse_view_projection * vec4(ndc, -1.0, 1.0);
+    vec4 far_point = inverse_view_projection * vec4(ndc, 1.0, 1.0);
+    vec3 origin = near_point.xyz / near_point.w;
+    vec3 direction = far_point.xyz / far_point.w - origin;
+
+    // O skybox continua sendo o interior de um cubo de tamanho finito ao redor
+    // da arena: intersectamos o raio com o cubo (método dos "slabs") e usamos
+    // o ponto de saída, que é a face interna visível.
+    vec3 inv_direction = 1.0 / direction;
+    vec3 t0 = (-vec3(sky_half_size) - origin) * inv_direction;
+    vec3 t1 = (vec3(sky_half_size) - origin) * inv_direction;
+    vec3 tmin = min(t0, t1);
+    vec3 tmax = max(t0, t1);
+    float t_enter = max(max(tmin.x, tmin.y), tmin.z);
+    float t_exit = min(min(tmax.x, tmax.y), tmax.z);
+
+    if (t_exit < max(t_enter, 0.0))
+        discard;
+
+    vec3 p = origin + t_exit * direction;
+
+    color.rgb = texture(SkyBoxCubemap, p).rgb;
+    color.a = 1;
+
+    // Cor final com correção gamma, considerando monitor sRGB.
+    color.rgb = pow(color.rgb, vec3(1.0,1.0,1.0)/2.2);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// Skybox desenhado como um único triângulo que cobre toda a tela. Os vértices
+// são gerados a partir de gl_VertexID, sem nenhum buffer de atributos.
+// Veja RenderSky() em "skybox.hpp".
+
+// Coordenadas NDC do pixel, interpoladas para o Fragment Shader
+out vec2 ndc;
+
+void main()
+{
+    const vec2 corners[3] = vec2[3](vec2(-1.0, -1.0), vec2(3.0, -1.0), vec2(-1.0, 3.0));
+    ndc = corners[gl_VertexID];
+
+    // z = w: após a divisão por w o triângulo fica exatamente no far plane.
+    // Com glDepthFunc(GL_LEQUAL), só passam os pixels onde nada foi desenhado,
+    // e o teste de profundidade antecipado (early-Z) descarta o restante antes
+    // de executar o Fragment Shader.
+    gl_Position = vec4(ndc, 1.0, 1.0);
+}
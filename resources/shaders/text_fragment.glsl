@@ -0,0 +1,17 @@
+#version 330 core
+
+// O atlas da fonte guarda somente a cobertura de cada pixel (canal R). O
+// fundo do painel usa uma região sólida do próprio atlas, de modo que texto e
+// fundo são desenhados com a mesma chamada.
+in vec2 texcoords;
+in vec4 color_v;
+
+uniform sampler2D FontAtlas;
+
+out vec4 color;
+
+void main()
+{
+    float coverage = texture(FontAtlas, texcoords).r;
+    color = vec4(color_v.rgb, color_v.a * coverage);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// Texto do painel de estatísticas. Os vértices já chegam em pixels da janela
+// (origem no canto inferior esquerdo); veja text_renderer.hpp.
+layout (location = 0) in vec4 position_texcoords; // xy: pixels, zw: atlas
+layout (location = 1) in vec4 vertex_color;
+
+uniform vec2 screen_size;
+
+out vec2 texcoords;
+out vec4 color_v;
+
+void main()
+{
+    gl_Position = vec4(2.0 * position_texcoords.xy / screen_size - 1.0, 0.0, 1.0);
+    texcoords = position_texcoords.zw;
+    color_v = vertex_color;
+}
@@ -0,0 +1,224 @@
+// Simulação do jogo sem janela e sem contexto OpenGL (alvo "pacman_headless").
+//
+// Executa somente a lógica de simulation.hpp, o mais rápido possível, com a
+// entrada gerada por um script determinístico no lugar do teclado. Ao final
+// mostra quantos passos de simulação foram executados por segundo de tempo
+// real. Serve para medir e comparar a lógica do jogo em máquinas sem monitor.
+//
+// Uso (a partir de bin/Linux, como o executável principal):
+//
+//     ./pacman_headless [--ticks N] [--seed S] [--ghosts G] [--threads T] [--level fase] [--record arquivo] [--profile]
+//     ./pacman_headless --replay arquivo [--ghosts G] [--threads T] [--level fase] [--profile]
+//     ./pacman_headless --maze-bench [--maze N] [--maze-seed S] [--threads T]
+//
+// As mesmas opções e a mesma semente produzem sempre o mesmo jogo. Com
+// "--replay" a entrada vem de uma gravação (do jogo ou daqui) e o estado
+// final é verificado; o código de saída é 1 se ele divergir. "--ghosts"
+// muda o número de fantasmas e deve ser o mesmo ao gravar e ao reproduzir.
+// "--level" troca a fase (texto ou binário, veja level.hpp), que também deve
+// ser a mesma ao gravar e ao reproduzir. "--threads" fixa o número de
+// threads trabalhadoras do sistema de jobs (0 executa tudo na thread
+// principal); o resultado é o mesmo com qualquer valor.
+//
+// "--maze N" usa um labirinto gerado de N x N células (maze_generator.hpp)
+// no lugar da fase. "--maze-bench" mede o custo da simulação em labirintos
+// de 20 x 20 até N x N (2000 por padrão) e grava "maze_bench.csv"; veja
+// maze_bench.hpp.
+
+// "headers" padrões de C
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+// Headers específicos de C++
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+// Headers da biblioteca GLM: criação de matrizes e vetores.
+#include <external/glm/mat4x4.hpp>
+#include <external/glm/vec4.hpp>
+
+// Headers da biblioteca para carregar modelos obj
+#include "external/tiny_obj_loader.h"
+
+// Headers locais, definidos na pasta "include/"
+#include "matrices.h"
+#include "objects/objects.hpp"
+#include "collisions/simd_collisions.hpp"
+#include "game/simulation.hpp"
+#include "game/input_record.hpp"
+#include "game/level.hpp"
+#include "game/maze_generator.hpp"
+#include "game/maze_bench.hpp"
+#include "globals/globals.hpp"
+#include "utils/profiler.hpp"
+#include "utils/job_system.hpp"
+
+// Duração de cada comando do script, em passos (meio segundo)
+const int SCRIPT_COMMAND_TICKS = (int)(SIMULATION_HZ / 2);
+
+// Gerador congruencial linear: mesma sequência em qualquer plataforma,
+// diferente de std::rand().
+uint32_t NextScriptRandom(uint32_t &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 16;
+}
+
+// Entrada do passo "tick": a cada SCRIPT_COMMAND_TICKS o Pac-Man escolhe uma
+// nova combinação de teclas. As direções são as da câmera de cima (modo
+// padrão), calculadas em main() a partir de camera_up_vector = (0, 0, -1).
+PacmanInput ScriptedInput(long long tick, uint32_t &state, PacmanInput &current)
+{
+    if (tick % SCRIPT_COMMAND_TICKS == 0)
+    {
+        uint32_t keys = NextScriptRandom(state);
+        current.forward = (keys & 3u) == 0;
+        current.backward = (keys & 3u) == 1;
+        current.right = ((keys >> 2) & 3u) == 0;
+        current.left = ((keys >> 2) & 3u) == 1;
+    }
+    current.forward_unit = glm::vec4(0.0f, 0.0f, -1.0f, 0.0f);
+    current.side_unit = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+    return current;
+}
+
+int main(int argc, char *argv[])
+{
+    long long total_ticks = (long long)(SIMULATION_HZ * 600); // Dez minutos de jogo
+    uint32_t seed = 1;
+    const char *record_file = NULL;
+    const char *replay_file = NULL;
+    int worker_count = -1;
+    const char *level_file = DEFAULT_LEVEL_FILE;
+    int maze_cells = 0;
+    uint32_t maze_seed = 1;
+    bool maze_bench = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            total_ticks = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--ghosts") == 0 && i + 1 < argc)
+            ghost_count = std::max(2, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            worker_count = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            level_file = argv[++i];
+        else if (strcmp(argv[i], "--maze") == 0 && i + 1 < argc)
+            maze_cells = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--maze-seed") == 0 && i + 1 < argc)
+            maze_seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--maze-bench") == 0)
+            maze_bench = true;
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_file = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_file = argv[++i];
+        else if (strcmp(argv[i], "--profile") == 0)
+            g_ProfilerEnabled = true;
+        else
+        {
+            fprintf(stderr, "Uso: %s [--ticks N] [--seed S] [--ghosts G] [--threads T] [--level fase] [--maze N] [--maze-seed S] [--maze-bench] [--record arquivo] [--replay arquivo] [--profile]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    InitCollisionKernels();
+    InitJobSystem(worker_count);
+    LoadLabyrinthObjects();
+    LoadEntityObjects();
+    if (maze_bench)
+    {
+        RunMazeBenchmarks(maze_cells > 0 ? maze_cells : MAZE_MAX_CELLS, maze_seed, "maze_bench.csv");
+        ShutdownJobSystem();
+        if (g_ProfilerEnabled)
+            DumpChromeTrace("pacman_trace_headless.json");
+        return 0;
+    }
+    if (maze_cells > 0 ? !GenerateMazeLevel(g_LevelArena, maze_cells, maze_seed, g_Level)
+                       : !LoadLevel(g_LevelArena, level_file, g_Level, IsMeshLoaded))
+        return 1;
+
+    InitializeWorld();
+    ResetFixedTimestep(0.0);
+
+    if (replay_file != NULL)
+    {
+        if (!OpenInputReplay(g_InputPlayer, replay_file))
+            return 1;
+        seed = g_InputPlayer.seed;
+        total_ticks = 0;
+    }
+    else if (record_file != NULL)
+    {
+        StartInputRecording(g_InputRecorder, record_file, seed);
+    }
+
+    uint32_t script_state = seed;
+    PacmanInput input = {};
+    bool restart = false;
+    long long games = 1;
+    long long pellets_eaten = 0;
+    long long wins = 0;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+
+    for (long long tick = 0; replay_file != NULL || tick < total_ticks; ++tick)
+    {
+        RecordedInput recorded;
+        if (replay_file != NULL)
+        {
+            if (!NextReplayInput(g_InputPlayer, recorded))
+                break;
+            total_ticks += 1;
+        }
+        else
+        {
+            recorded = CaptureInput(ScriptedInput(tick, script_state, input), restart);
+            RecordInputTick(g_InputRecorder, recorded);
+        }
+
+        if (recorded.restart)
+        {
+            pellets_eaten += eaten_ball_count;
+            wins += won_game ? 1 : 0;
+            games += 1;
+        }
+        RunRecordedTick(recorded);
+
+        // Fim de jogo: o mundo é recriado no passo seguinte, como na tecla espaço
+        restart = game_over;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    pellets_eaten += eaten_ball_count;
+
+    printf("Headless: %lld ticks (%.1f s de jogo a %.0f Hz) em %.3f s\n",
+           total_ticks, total_ticks / SIMULATION_HZ, SIMULATION_HZ, seconds);
+    printf("  %.0f ticks/s, %.3f us/tick, %.0fx tempo real\n",
+           total_ticks / seconds, seconds * 1e6 / (double)total_ticks, total_ticks / SIMULATION_HZ / seconds);
+    printf("  kernels: %s, semente: %u, fantasmas: %d, jogos: %lld, vitórias: %lld, bolinhas comidas: %lld\n",
+           CollisionKernelLevelName(g_CollisionKernelLevel), seed, GhostCount(ghosts), games, wins, pellets_eaten);
+    printf("  threads trabalhadoras: %d\n", JobWorkerCount());
+    printf("  Pac-Man em (%.3f, %.3f, %.3f)\n", pacman_position_c.x, pacman_position_c.y, pacman_position_c.z);
+
+    int status = 0;
+    if (replay_file != NULL)
+        status = FinishInputReplay(g_InputPlayer, SimulationChecksum()) ? 0 : 1;
+    else if (record_file != NULL)
+        FinishInputRecording(g_InputRecorder, SimulationChecksum());
+
+    ShutdownJobSystem();
+    if (g_ProfilerEnabled)
+        DumpChromeTrace("pacman_trace_headless.json");
+
+    return status;
+}
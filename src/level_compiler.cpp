@@ -0,0 +1,31 @@
+// Compila uma fase em texto para o formato binário de level.hpp (alvo
+// "level_compiler"). O jogo aceita os dois formatos em "--level"; o binário
+// só dispensa a etapa de compilação ao carregar.
+//
+// Uso:
+//
+//     ./level_compiler entrada.lvl saida.lvlb
+
+// "headers" padrões de C
+#include <cstdio>
+
+// Headers locais, definidos na pasta "include/"
+#include "game/level.hpp"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Uso: %s entrada.lvl saida.lvlb\n", argv[0]);
+        return 1;
+    }
+
+    LevelView level;
+    if (!LoadLevel(g_LevelArena, argv[1], level) || !SaveLevelBlob(level, argv[2]))
+        return 1;
+
+    const LevelHeader &header = *level.header;
+    printf("%s: %u paredes, %u bolinhas, %u cerejas, %u fantasmas (%u bytes)\n", argv[2], header.wall_count,
+           header.pellet_count, header.cherry_count, header.ghost_count, header.size);
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 // Headers específicos de C++
 #include <map>
@@ -44,12 +45,29 @@
 #include "objects/numbers.hpp"
 #include "objects/objects.hpp"
 #include "objects/pacman.hpp"
+#include "objects/render_packets.hpp"
 #include "objects/wall.hpp"
+#include "objects/skybox.hpp"
 #include "callbacks/callbacks.hpp"
 #include "collisions/collisions.hpp"
+#include "collisions/simd_collisions.hpp"
+#include "collisions/collision_bench.hpp"
+#include "game/simulation.hpp"
+#include "game/input_record.hpp"
+#include "game/level.hpp"
+#include "game/maze_generator.hpp"
 #include "globals/globals.hpp"
 #include "utils/error_utils.h"
 #include "utils/shader_utils.hpp"
+#include "utils/shader_watcher.hpp"
+#include "utils/gpu_timers.hpp"
+#include "utils/render_scale.hpp"
+#include "utils/frame_pacer.hpp"
+#include "utils/input_latency.hpp"
+#include "utils/job_system.hpp"
+#include "utils/profiler.hpp"
+#include "utils/text_renderer.hpp"
+#include "utils/stats_overlay.hpp"
 #include "utils/texture_utils.hpp"
 
 // Declaração de funções utilizadas para pilha de matrizes de modelagem.
@@ -71,18 +89,56 @@ glm::vec4 camera_up_unit;
 glm::vec4 camera_side_view;
 glm::vec4 camera_side_view_unit;
 
-Ghost first_ghost;
-Ghost second_ghost;
-std::vector<Ball> balls;
-std::vector<Cherry> cherries;
-std::vector<Wall> walls;
-int initial_ball_count;
-int eaten_ball_count;
-
 void initialize_game();
 
 int main(int argc, char *argv[])
 {
+    // Opções de linha de comando. "--profile" liga o profiler de CPU desde o
+    // início e salva o trace ao sair; "--bench-collisions" mede os kernels de
+    // colisão e sai sem abrir a janela; "--record arquivo" grava a entrada
+    // de cada passo e "--replay arquivo" a reproduz (veja input_record.hpp);
+    // o primeiro argumento que não é uma opção é um modelo OBJ extra a ser
+    // carregado.
+    bool profile_from_start = false;
+    bool bench_collisions = false;
+    const char *record_file = NULL;
+    const char *replay_file = NULL;
+    const char *extra_model = NULL;
+    const char *level_file = DEFAULT_LEVEL_FILE;
+    int maze_cells = 0;
+    uint32_t maze_seed = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--profile") == 0)
+            profile_from_start = true;
+        else if (strcmp(argv[i], "--bench-collisions") == 0)
+            bench_collisions = true;
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_file = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_file = argv[++i];
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            level_file = argv[++i];
+        else if (strcmp(argv[i], "--maze") == 0 && i + 1 < argc)
+            maze_cells = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--maze-seed") == 0 && i + 1 < argc)
+            maze_seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (extra_model == NULL)
+            extra_model = argv[i];
+    }
+    g_ProfilerEnabled = profile_from_start;
+
+    InitCollisionKernels();
+    if (bench_collisions)
+    {
+        RunCollisionBenchmarks();
+        return 0;
+    }
+    InitJobSystem();
+
+    if (replay_file != NULL && !OpenInputReplay(g_InputPlayer, replay_file))
+        std::exit(EXIT_FAILURE);
+
     // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
     // sistema operacional, onde poderemos renderizar com OpenGL.
     int success = glfwInit();
@@ -150,13 +206,40 @@ int main(int argc, char *argv[])
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
 
     // Carregamos os shaders de vértices e de fragmentos que serão utilizados
+    InitProgramBinaryCache();
     LoadShadersFromFiles();
     LoadTexturesFromFiles();
+    LoadPelletImpostors();
+    LoadSkybox();
+    LoadTextRenderer();
+    LoadScoreDisplay();
     LoadObjects();
 
-    if (argc > 1)
+    // A fase, lida de arquivo ou gerada; o labirinto gerado usa a AABB das
+    // malhas carregadas acima.
+    if (maze_cells > 0 ? !GenerateMazeLevel(g_LevelArena, maze_cells, maze_seed, g_Level)
+                       : !LoadLevel(g_LevelArena, level_file, g_Level, IsMeshLoaded))
+        std::exit(EXIT_FAILURE);
+
+    // Queries para medir o tempo de GPU de cada etapa da renderização
+    InitGpuTimers();
+
+    // Alterações nos arquivos GLSL são recompiladas em segundo plano
+    RegisterHotReloadProgram("../../resources/shaders/shader_vertex.glsl", "../../resources/shaders/shader_fragment.glsl",
+                             &g_GpuProgramID, SetupGpuProgram);
+    RegisterHotReloadProgram("../../resources/shaders/pellet_vertex.glsl", "../../resources/shaders/pellet_fragment.glsl",
+                             &g_PelletProgramID, SetupPelletProgram);
+    RegisterHotReloadProgram("../../resources/shaders/sky_vertex.glsl", "../../resources/shaders/sky_fragment.glsl",
+                             &g_SkyProgramID, SetupSkyProgram);
+    RegisterHotReloadProgram("../../resources/shaders/text_vertex.glsl", "../../resources/shaders/text_fragment.glsl",
+                             &g_TextProgramID, SetupTextProgram);
+    RegisterHotReloadProgram("../../resources/shaders/score_vertex.glsl", "../../resources/shaders/score_fragment.glsl",
+                             &g_ScoreProgramID, SetupScoreProgram);
+    StartShaderWatcher();
+
+    if (extra_model != NULL)
     {
-        ObjModel model(argv[1]);
+        ObjModel model(extra_model);
         BuildTrianglesAndAddToVirtualScene(&model);
     }
 
@@ -171,17 +254,44 @@ int main(int argc, char *argv[])
     // chama a função que inicializa o jogo:
     initialize_game();
 
-    char count_first_digit[4] = {0};
-    char count_second_digit[4] = {0};
-    char count_third_digit[4] = {0};
+    if (record_file != NULL && !g_InputPlayer.active)
+        StartInputRecording(g_InputRecorder, record_file, 0);
+
+    // Sincronizamos a troca de buffers com o monitor; a tecla V alterna o modo.
+    InitFramePacer(window, FramePacerMode::VSYNC);
+    InitInputLatency();
+
+    // Pacotes de desenho de cada quadro; os vetores são reaproveitados.
+    RenderPacketList wall_packets, ghost_packets, cherry_packets;
 
     // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
     while (!glfwWindowShouldClose(window))
     {
+        PROFILE_SCOPE("Frame");
 
-        if (should_restart) // se o usuário restartar, a função de inicializar o jogo é chamada novamente
+        // Aguardamos o início do próximo quadro (somente no modo limitado) e
+        // registramos o intervalo entre quadros.
+        FramePacerBeginFrame();
+        StatsOverlayBeginFrame();
+        BeginCpuStage(CPU_STAGE_INPUT);
+
+        // Verificamos com o sistema operacional se houve alguma interação do
+        // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
+        // definidas anteriormente usando glfwSet*Callback() serão chamadas
+        // pela biblioteca GLFW. A leitura é feita antes de qualquer uso do
+        // estado da entrada (reinício, câmera, movimento do Pac-Man), para
+        // que uma tecla afete já o quadro atual e não o seguinte.
+        PollInput();
+        BeginCpuStage(CPU_STAGE_UPDATE);
+
+        if (should_restart && replay_file != NULL) // Na reprodução, os reinícios vêm da gravação
+        {
+            should_restart = false;
+        }
+        else if (should_restart) // se o usuário restartar, a função de inicializar o jogo é chamada novamente
         {
             initialize_game();
+            NoteInputRestart(g_InputRecorder);
         }
         // Aqui executamos as operações de renderização
 
@@ -193,24 +303,27 @@ int main(int argc, char *argv[])
         //           R     G     B     A
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
+        // A cena é desenhada em um framebuffer fora da tela, com resolução
+        // ajustada pelo tempo de GPU dos quadros anteriores.
+        GpuTimersBeginFrame();
+        BeginDynamicResolutionFrame();
+
         // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
         // e também resetamos todos os pixels do Z-buffer (depth buffer).
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // Troca os programas de GPU cuja recompilação em segundo plano terminou
+        UpdateShaderHotReload();
+
         // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
         // os shaders de vértice e fragmentos).
         glUseProgram(g_GpuProgramID);
 
-        float currentTime = (float)glfwGetTime();
-        float elapsedTime = currentTime - previousTime;
-        previousTime = currentTime;
-
-        if (t <= 1)
-        {
-            t += 0.008;
-            curr_bezier_position = calculateBezierPosition(initial_position_bezier, intermediate_position_bezier_1, intermediate_position_bezier_2, final_position_bezier, t);
-            pacman_position_c = curr_bezier_position;
-        }
+        // Estados do jogo que alteram a aparência da cena são enviados como
+        // "uniforms" comuns; nenhum evento do jogo recompila shaders.
+        glUniform1i(g_is_free_cam_on_uniform, isFreeCamOn);
+        glUniform1i(g_game_over_uniform, game_over);
+        glUniform1i(g_won_game_uniform, won_game);
 
         float g_CameraPhiSin = sin(g_CameraPhi);
         float g_CameraPhiCos = cos(g_CameraPhi);
@@ -230,12 +343,6 @@ int main(int argc, char *argv[])
         if (isFreeCamOn)
         {
             camera_view_vector = glm::vec4(-x, -y, -z, 0.0f);
-            camera_view_unit = camera_view_vector / norm(camera_view_vector);
-            camera_distance = PACMAN_DISTANCE * camera_view_unit;
-            camera_distance.y = camera_view_unit.y - 0.3f;
-            camera_position_c = pacman_position_c - camera_distance;
-
-            pacman_rotation = -atan2(camera_view_unit.z, camera_view_unit.x);
         }
         else
         {
@@ -251,57 +358,61 @@ int main(int argc, char *argv[])
 
         glm::vec4 camera_v_view_unit = camera_view_unit;
         camera_v_view_unit.y = 0.0f;
-        glm::vec4 vertical_move_unit = isFreeCamOn ? camera_v_view_unit : camera_up_unit;
-
-        // Note que, no sistema de coordenadas da câmera, os planos near e far
-        // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
-        float nearplane = -0.1f; // Posição do "near plane"
-        float farplane = -40.0f; // Posição do "far plane"
-
-        Sphere pacman_sphere = {pacman_position_c, pacman_size + 0.1f};
-        std::vector<glm::vec4> all_collision_directions;
-        glDepthFunc(GL_ALWAYS);
-
-        glm::mat4 skyModel = Matrix_Scale(farplane / 4, farplane / 4, farplane / 4);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(skyModel));
-        glUniform1i(g_object_id_uniform, BACKGROUND);
-        DrawVirtualObject("Cube");
-
-        glm::vec3 skyboxMin = glm::vec3(farplane / 4, farplane / 2, farplane / 4);
-        glm::vec3 skyboxMax = glm::vec3(-farplane / 4, -farplane / 2, -farplane / 4);
-
-        AABB sky_bbox = {skyboxMin, skyboxMax};
 
-        glDepthFunc(GL_LESS);
-
-        checkWallsCollision(walls, pacman_sphere, all_collision_directions);
-        checkLittleBallsCollision(balls, pacman_sphere, eaten_ball_count);
-        checkCherriesCollision(cherries, pacman_sphere);
-
-        if (shouldBoostSpeed)
+        // Entrada lida neste quadro, usada por todos os passos de simulação dele
+        PacmanInput input;
+        input.forward = movePacmanForward;
+        input.backward = movePacmanBackward;
+        input.right = movePacmanRight;
+        input.left = movePacmanLeft;
+        input.forward_unit = isFreeCamOn ? camera_v_view_unit : camera_up_unit;
+        input.side_unit = camera_side_view_unit;
+
+        // Executamos quantos passos fixos de simulação couberem no tempo
+        // decorrido desde o quadro anterior (veja simulation.hpp). Na
+        // reprodução de uma gravação, todo quadro executa o mesmo número de
+        // passos, independente do relógio, para que a carga seja idêntica
+        // em toda execução.
+        if (replay_file != NULL)
         {
-            pacmanPreviousTime = previousTime;
-            BoostPacmanSpeed(pacmanPreviousTime);
+            for (int i = 0; i < REPLAY_TICKS_PER_FRAME; ++i)
+            {
+                RecordedInput recorded;
+                if (!NextReplayInput(g_InputPlayer, recorded))
+                {
+                    glfwSetWindowShouldClose(window, GL_TRUE);
+                    break;
+                }
+                RunRecordedTick(recorded);
+            }
+        }
+        else
+        {
+            int ticks = AdvanceFixedTimestep(glfwGetTime());
+            for (int i = 0; i < ticks; ++i)
+            {
+                RecordInputTick(g_InputRecorder, CaptureInput(input, false));
+                SimulationTick(input);
+            }
         }
 
-        renderCount(eaten_ball_count, count_first_digit, count_second_digit, count_third_digit);
-
-        // Testes de colisão com as paredes limítrofes: colisão esfera-plano
-        glm::vec4 collision_direction_sky = checkSphereToPlaneCollision(sky_bbox, pacman_sphere);
-        all_collision_directions.push_back(collision_direction_sky);
-
-        MovePacman(vertical_move_unit, camera_side_view_unit, elapsedTime, all_collision_directions);
+        // Posição do Pac-Man entre os dois últimos passos, usada pela câmera
+        // e pelo desenho
+        float alpha = replay_file != NULL ? 1.0f : FixedTimestepAlpha();
+        glm::vec4 pacman_render_position = InterpolatedPacmanPosition(alpha);
 
-        first_ghost.move(elapsedTime);
-        second_ghost.move(elapsedTime);
-        won_game = balls.size() == 0;
-        game_over = first_ghost.collided(pacman_sphere) || second_ghost.collided(pacman_sphere) || won_game;
-        if (game_over && should_reload)
+        if (isFreeCamOn)
         {
-            ReloadShaders();
-            should_reload = false;
+            camera_distance = PACMAN_DISTANCE * camera_view_unit;
+            camera_distance.y = camera_view_unit.y - 0.3f;
+            camera_position_c = pacman_render_position - camera_distance;
         }
 
+        // Note que, no sistema de coordenadas da câmera, os planos near e far
+        // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
+        float nearplane = -0.1f; // Posição do "near plane"
+        float farplane = -40.0f; // Posição do "far plane"
+
         // Computamos a matriz "View" utilizando os parâmetros da câmera para
         // definir o sistema de coordenadas da câmera.  Veja slides 2-14, 184-190 e 236-242 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
         glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
@@ -330,59 +441,92 @@ int main(int argc, char *argv[])
             projection = Matrix_Orthographic(l, r, b, t, nearplane, farplane);
         }
 
+        // Daqui até a troca de buffers, somente submissão de comandos OpenGL
+        PROFILE_SCOPE("Render");
+        BeginCpuStage(CPU_STAGE_RENDER);
+
+        // Matrizes de modelagem e visibilidade das paredes, dos fantasmas e das
+        // cerejas, calculadas em jobs (veja render_packets.hpp); a thread
+        // principal ajuda e depois só faz as chamadas OpenGL.
+        Frustum frustum = ExtractFrustum(projection * view);
+        {
+            JobGraph render_jobs;
+            AddJob(render_jobs, "WallPacketsJob", [&]()
+                   {
+                ResizeRenderPackets(wall_packets, (int)walls.model.size());
+                ParallelFor("BuildWallPackets", (int)walls.model.size(), RENDER_PACKET_JOB_GRAIN, [&](int begin, int end)
+                            { BuildWallPackets(walls, frustum, wall_packets, begin, end); }); });
+            AddJob(render_jobs, "GhostPacketsJob", [&]()
+                   {
+                ResizeRenderPackets(ghost_packets, GhostCount(ghosts));
+                ParallelFor("BuildGhostPackets", GhostCount(ghosts), RENDER_PACKET_JOB_GRAIN, [&](int begin, int end)
+                            { BuildGhostPackets(ghosts, alpha, frustum, ghost_packets, begin, end); }); });
+            AddJob(render_jobs, "CherryPacketsJob", [&]()
+                   {
+                ResizeRenderPackets(cherry_packets, CherryCount(cherries));
+                BuildCherryPackets(cherries, frustum, cherry_packets, 0, CherryCount(cherries)); });
+            RunJobGraph(render_jobs);
+        }
+
         glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
 
+        // Redesenha a textura do placar, somente se a pontuação mudou
+        UpdateScoreTexture(eaten_ball_count, isFreeCamOn);
+
         // Enviamos as matrizes "view" e "projection" para a placa de vídeo
         // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
         // efetivamente aplicadas em todos os pontos.
         glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
         glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
 
-        model = Matrix_Translate(0.0f, -1.0f, 0.0f) * Matrix_Scale(farplane / 4, 1.0f, farplane / 4);
+        // Cada etapa abaixo tem seu tempo de GPU medido; veja gpu_timers.hpp.
+        BeginGpuPass(GPU_PASS_FLOOR);
+        // O chão cobre a arena inteira, no mínimo o volume do skybox
+        float floor_scale = std::min(farplane / 4, -std::max(std::max(-g_ArenaBounds.min.x, g_ArenaBounds.max.x),
+                                                             std::max(-g_ArenaBounds.min.z, g_ArenaBounds.max.z)));
+        model = Matrix_Translate(0.0f, -1.0f, 0.0f) * Matrix_Scale(floor_scale, 1.0f, floor_scale);
         glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
         glUniform1i(g_object_id_uniform, PLANE);
         DrawVirtualObject("the_plane");
+        EndGpuPass();
+
+        BeginGpuPass(GPU_PASS_MAZE);
+        DrawRenderPackets(wall_packets);
+        EndGpuPass();
 
-        model = Matrix_Translate(pacman_position_c.x, pacman_position_c.y, pacman_position_c.z) * Matrix_Rotate_Y(pacman_rotation) * Matrix_Scale(pacman_size, pacman_size, pacman_size);
+        BeginGpuPass(GPU_PASS_ACTORS);
+        model = Matrix_Translate(pacman_render_position.x, pacman_render_position.y, pacman_render_position.z) * Matrix_Rotate_Y(pacman_rotation) * Matrix_Scale(pacman_size, pacman_size, pacman_size);
         glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
         glUniform1i(g_object_id_uniform, PACMAN);
         DrawVirtualObject("pacman");
 
-        first_ghost.render();
-        second_ghost.render();
+        DrawRenderPackets(ghost_packets);
+        EndGpuPass();
 
-        model = Matrix_Translate(1.0f, isFreeCamOn ? 2.0f : -1.0f, isFreeCamOn ? (farplane / 4) : 0.0f) * Matrix_Rotate_X(isFreeCamOn ? 0.0f : 3.14159f / 2) * Matrix_Rotate_Z(isFreeCamOn ? 0.0f : 3.14159f) * Matrix_Rotate_Y(isFreeCamOn ? 0.0f : 3.14159f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COUNT_1);
-        DrawVirtualObject(count_first_digit);
+        // Placar: um quadrilátero com a textura gerada por UpdateScoreTexture()
+        BeginGpuPass(GPU_PASS_HUD);
+        RenderScore(view, projection, isFreeCamOn, farplane);
+        EndGpuPass();
 
-        model = Matrix_Translate(0.0f, isFreeCamOn ? 2.0f : -1.0f, isFreeCamOn ? (farplane / 4) : 0.0f) * Matrix_Rotate_X(isFreeCamOn ? 0.0f : 3.14159f / 2) * Matrix_Rotate_Z(isFreeCamOn ? 0.0f : 3.14159f) * Matrix_Rotate_Y(isFreeCamOn ? 0.0f : 3.14159f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COUNT_2);
-        DrawVirtualObject(count_second_digit);
+        // Itens coletáveis. As bolinhas são desenhadas com um programa de GPU
+        // próprio (impostores), por isso ficam por último.
+        BeginGpuPass(GPU_PASS_PELLETS);
+        DrawRenderPackets(cherry_packets);
+        RenderPellets(pellets, view, projection);
+        EndGpuPass();
 
-        model = Matrix_Translate(-1.0f, isFreeCamOn ? 2.0f : -1.0f, isFreeCamOn ? (farplane / 4) : 0.0f) * Matrix_Rotate_X(isFreeCamOn ? 0.0f : 3.14159f / 2) * Matrix_Rotate_Z(isFreeCamOn ? 0.0f : 3.14159f) * Matrix_Rotate_Y(isFreeCamOn ? 0.0f : 3.14159f);
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform1i(g_object_id_uniform, COUNT_3);
-        DrawVirtualObject(count_third_digit);
+        // O skybox é desenhado por último: somente os pixels não cobertos pela
+        // cena executam o Fragment Shader.
+        BeginGpuPass(GPU_PASS_SKY);
+        RenderSky(view, projection, -farplane / 4);
+        EndGpuPass();
 
-        if (isFreeCamOn)
-        {
-            model = Matrix_Translate(-1.0f, 2.0f, -farplane / 4) * Matrix_Rotate_Y(3.14159f);
-            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform1i(g_object_id_uniform, COUNT_1);
-            DrawVirtualObject(count_first_digit);
-
-            model = Matrix_Translate(0.0f, 2.0f, -farplane / 4) * Matrix_Rotate_Y(3.14159f);
-            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform1i(g_object_id_uniform, COUNT_2);
-            DrawVirtualObject(count_second_digit);
-
-            model = Matrix_Translate(1.0f, 2.0f, -farplane / 4) * Matrix_Rotate_Y(3.14159f);
-            glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform1i(g_object_id_uniform, COUNT_3);
-            DrawVirtualObject(count_third_digit);
-        }
+        // Ampliamos a imagem renderizada para o tamanho da janela
+        EndDynamicResolutionFrame();
+        GpuTimersEndFrame();
+
+        // Painel de estatísticas (tecla H), em resolução nativa
+        RenderStatsOverlay(g_DynamicResolution.window_width, g_DynamicResolution.window_height);
 
         // O framebuffer onde OpenGL executa as operações de renderização não
         // é o mesmo que está sendo mostrado para o usuário, caso contrário
@@ -390,35 +534,36 @@ int main(int argc, char *argv[])
         // chamada abaixo faz a troca dos buffers, mostrando para o usuário
         // tudo que foi renderizado pelas funções acima.
         // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
-        glfwSwapBuffers(window);
-
-        // Verificamos com o sistema operacional se houve alguma interação do
-        // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
-        // definidas anteriormente usando glfwSet*Callback() serão chamadas
-        // pela biblioteca GLFW.
-        glfwPollEvents();
+        BeginCpuStage(CPU_STAGE_SWAP);
+        MarkFrameRendered();
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        MarkFramePresented();
+        EndCpuStages();
     }
 
     // Finalizamos o uso dos recursos do sistema operacional
+    PrintFrameIntervalStats();
+    int exit_status = 0;
+    if (replay_file != NULL)
+        exit_status = FinishInputReplay(g_InputPlayer, SimulationChecksum()) ? 0 : EXIT_FAILURE;
+    FinishInputRecording(g_InputRecorder, SimulationChecksum());
+    StopShaderWatcher();
+    ShutdownJobSystem();
+    if (g_ProfilerEnabled)
+        DumpChromeTrace("pacman_trace.json");
     glfwTerminate();
 
     // Fim do programa
-    return 0;
+    return exit_status;
 }
 
 void initialize_game()
 {
-    inicialize_globals();
-    balls = instanciateLittleBalls();
-    cherries = instanciateCherries();
-    walls = instanciateWalls();
-    first_ghost = instanciateGhost(FIRST);
-    second_ghost = instanciateGhost(SECOND);
-
-    initial_ball_count = balls.size();
-    eaten_ball_count = 0;
-
-    ReloadShaders();
+    InitializeWorld();
+    ResetFixedTimestep(glfwGetTime());
 }
 
 // Função que pega a matriz M e guarda a mesma no topo da pilha